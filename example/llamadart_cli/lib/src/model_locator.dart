@@ -2,6 +2,7 @@ import 'dart:convert';
 import 'dart:io';
 
 import 'package:http/http.dart' as http;
+import 'package:llamadart/llamadart.dart' show inspectGgufFile;
 import 'package:path/path.dart' as p;
 
 import 'llama_cli_config.dart';
@@ -227,7 +228,9 @@ class ModelLocator {
     final targetFile = File(p.join(modelsDir.path, filename));
     final tempFile = File('${targetFile.path}.download');
 
-    if (targetFile.existsSync() && targetFile.lengthSync() > 0) {
+    if (targetFile.existsSync() &&
+        targetFile.lengthSync() > 0 &&
+        _isUsableModelFile(targetFile)) {
       final bytes = targetFile.lengthSync();
       onProgress?.call(
         DownloadProgress(receivedBytes: bytes, totalBytes: bytes),
@@ -292,6 +295,15 @@ class ModelLocator {
       await targetFile.delete();
     }
 
+    if (!_isUsableModelFile(tempFile, gguf: filename.endsWith('.gguf'))) {
+      // Drop the partial so the next attempt starts from scratch.
+      await tempFile.delete();
+      throw HttpException(
+        'Downloaded model $filename is truncated or not a valid GGUF file.',
+        uri: uri,
+      );
+    }
+
     await tempFile.rename(targetFile.path);
     final finalBytes = targetFile.lengthSync();
     onProgress?.call(
@@ -303,6 +315,21 @@ class ModelLocator {
     return targetFile.absolute.path;
   }
 
+  /// Whether [file] holds a complete GGUF model.
+  ///
+  /// Non-GGUF names are accepted as-is; GGUF files are checked against their
+  /// tensor table so interrupted downloads are not mistaken for models.
+  bool _isUsableModelFile(File file, {bool? gguf}) {
+    if (!(gguf ?? file.path.endsWith('.gguf'))) {
+      return true;
+    }
+    try {
+      return inspectGgufFile(file.path).isComplete;
+    } on FormatException {
+      return false;
+    }
+  }
+
   bool _isHttpUrl(String value) {
     return value.startsWith('http://') || value.startsWith('https://');
   }
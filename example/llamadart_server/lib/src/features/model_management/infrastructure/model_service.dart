@@ -1,6 +1,6 @@
 import 'dart:io';
 
-import 'package:http/http.dart' as http;
+import 'package:llamadart/llamadart.dart' show ModelDownloader;
 import 'package:path/path.dart' as path;
 
 /// Resolves a model path or downloads a model URL into local cache.
@@ -8,9 +8,15 @@ class ModelService {
   /// Directory where downloaded model files are cached.
   final String cacheDir;
 
+  final ModelDownloader _downloader;
+
   /// Creates a model service with optional custom [cacheDir].
-  ModelService([String? cacheDir])
-    : cacheDir = cacheDir ?? path.join(Directory.current.path, 'models');
+  ///
+  /// Downloads use parallel range requests and resume after interruption;
+  /// pass [downloader] to tune connection count or chunk size.
+  ModelService([String? cacheDir, ModelDownloader? downloader])
+    : cacheDir = cacheDir ?? path.join(Directory.current.path, 'models'),
+      _downloader = downloader ?? ModelDownloader();
 
   /// Ensures [urlOrPath] exists locally, downloading when needed.
   Future<File> ensureModel(String urlOrPath) async {
@@ -28,66 +34,36 @@ class ModelService {
 
   Future<File> _downloadModel(String url) async {
     final fileName = url.split('/').last.split('?').first;
-    final file = File(path.join(cacheDir, fileName));
-
-    if (file.existsSync() && file.lengthSync() > 0) {
-      return file;
-    }
+    final target = path.join(cacheDir, fileName);
 
-    if (!file.parent.existsSync()) {
-      file.parent.createSync(recursive: true);
+    if (!File(target).existsSync()) {
+      stdout.writeln('Downloading model: $fileName');
     }
 
-    stdout.writeln('Downloading model: $fileName');
-
-    final client = http.Client();
-    try {
-      final request = http.Request('GET', Uri.parse(url));
-      final response = await client.send(request);
-
-      if (response.statusCode != HttpStatus.ok) {
-        throw Exception(
-          'Failed to download model: '
-          '${response.statusCode} ${response.reasonPhrase}',
-        );
-      }
-
-      final contentLength = response.contentLength ?? 0;
-      var downloaded = 0;
-      final sink = file.openWrite();
-
-      await response.stream
-          .listen(
-            (List<int> chunk) {
-              sink.add(chunk);
-              downloaded += chunk.length;
-
-              if (contentLength > 0) {
-                final progress = (downloaded / contentLength * 100)
-                    .toStringAsFixed(1);
-                stdout.write('\rProgress: $progress%');
-              } else {
-                final mb = (downloaded / 1024 / 1024).toStringAsFixed(1);
-                stdout.write('\rDownloaded: $mb MB');
-              }
-            },
-            onDone: () async {
-              await sink.close();
-              stdout.writeln('\nDownload complete.');
-            },
-            onError: (Object error) {
-              sink.close();
-              if (file.existsSync()) {
-                file.deleteSync();
-              }
-              throw error;
-            },
-          )
-          .asFuture<void>();
-
-      return file;
-    } finally {
-      client.close();
+    var lastPermille = -1;
+    var reported = false;
+    final file = await _downloader.download(
+      Uri.parse(url),
+      target,
+      onProgress: (progress) {
+        if (progress.receivedBytes == progress.resumedBytes) return;
+        reported = true;
+        final fraction = progress.fraction;
+        if (fraction == null) {
+          final mb = (progress.receivedBytes / 1024 / 1024).toStringAsFixed(1);
+          stdout.write('\rDownloaded: $mb MB');
+          return;
+        }
+        final permille = (fraction * 1000).floor();
+        if (permille != lastPermille) {
+          lastPermille = permille;
+          stdout.write('\rProgress: ${(fraction * 100).toStringAsFixed(1)}%');
+        }
+      },
+    );
+    if (reported) {
+      stdout.writeln('\nDownload complete.');
     }
+    return file;
   }
 }
@@ -37,12 +37,46 @@ export 'src/core/template/chat_template_engine.dart' show ChatTemplateEngine;
 export 'src/core/template/chat_template_handler.dart' show ChatTemplateHandler;
 
 // Backend (interface only)
-export 'src/backends/backend.dart' show LlamaBackend;
+export 'src/backends/backend.dart'
+    show
+        LlamaBackend,
+        LlamaLoraStatsBackend,
+        LlamaPromptLookupBackend,
+        LlamaModelInspectionBackend,
+        LlamaModelDownloadBackend,
+        LlamaVocabBackend,
+        LlamaBatchTokenizerBackend,
+        LlamaQuantizationBackend;
 
 // Models - Inference
 export 'src/core/models/inference/model_params.dart';
 export 'src/core/models/inference/generation_params.dart';
 export 'src/core/models/inference/tool_choice.dart';
+export 'src/core/models/inference/lora_switch_stats.dart';
+export 'src/core/models/inference/prompt_lookup_stats.dart';
+
+// Models - GGUF inspection
+export 'src/core/gguf/gguf_model_info.dart';
+export 'src/core/gguf/gguf_reader.dart';
+export 'src/backends/llama_cpp/gguf_file_source.dart'
+    if (dart.library.js_interop) 'src/backends/llama_cpp/gguf_file_source_stub.dart'
+    show inspectGgufFile;
+
+// Model downloads
+export 'src/core/download/model_download_progress.dart';
+export 'src/backends/llama_cpp/model_downloader.dart'
+    if (dart.library.js_interop) 'src/backends/llama_cpp/model_downloader_stub.dart'
+    show ModelDownloader;
+
+// Quantization
+export 'src/core/quantization/quantization_type.dart';
+export 'src/core/quantization/quantization_params.dart';
+export 'src/core/quantization/quantization_planner.dart';
+
+// Vocabulary
+export 'src/core/vocab/token_batch.dart';
+export 'src/core/vocab/vocab_piece_table.dart';
+export 'src/core/vocab/utf8_assembler.dart';
 
 // Models - Chat
 export 'src/core/models/chat/chat_message.dart';
@@ -62,6 +96,7 @@ export 'src/core/llama_logger.dart';
 export 'src/core/models/config/log_level.dart';
 export 'src/core/models/config/gpu_backend.dart';
 export 'src/core/models/config/lora_config.dart';
+export 'src/core/models/config/threading_config.dart';
 
 // Utils
 export 'src/core/exceptions.dart';
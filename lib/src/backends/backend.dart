@@ -1,7 +1,16 @@
+import 'dart:typed_data';
+
+import '../core/gguf/gguf_model_info.dart';
 import '../core/models/inference/model_params.dart';
 import '../core/models/inference/generation_params.dart';
+import '../core/models/inference/lora_switch_stats.dart';
+import '../core/models/inference/prompt_lookup_stats.dart';
+import '../core/vocab/token_batch.dart';
+import '../core/vocab/vocab_piece_table.dart';
 import '../core/models/chat/content_part.dart';
 import '../core/models/config/log_level.dart';
+import '../core/quantization/quantization_params.dart';
+import '../core/quantization/quantization_planner.dart';
 
 import 'llama_cpp/llama_cpp_backend.dart'
     if (dart.library.js_interop) 'web/web_backend.dart';
@@ -120,3 +129,106 @@ abstract class LlamaBackend {
     bool addAssistant = true,
   });
 }
+
+/// Optional capability for backends that apply per-request LoRA adapter sets.
+///
+/// Kept separate from [LlamaBackend] so existing backend implementations do
+/// not need to change; callers check for it with `backend is
+/// LlamaLoraStatsBackend`.
+abstract class LlamaLoraStatsBackend {
+  /// Returns adapter switching statistics for [contextHandle].
+  Future<LoraSwitchStats> loraSwitchStats(int contextHandle);
+}
+
+/// Optional capability for backends that support prompt-lookup speculative
+/// decoding (`GenerationParams.promptLookupDraftTokens`).
+abstract class LlamaPromptLookupBackend {
+  /// Returns prompt-lookup decoding statistics for [contextHandle].
+  Future<PromptLookupStats> promptLookupStats(int contextHandle);
+}
+
+/// Optional capability for backends that can read GGUF metadata from a local
+/// path without loading weights.
+abstract class LlamaModelInspectionBackend {
+  /// Parses the header, metadata and tensor table of the model at [path].
+  Future<GgufModelInfo> inspectModel(String path);
+
+  /// Returns the header parsed while loading [modelHandle], or null when the
+  /// load could not inspect it.
+  GgufModelInfo? loadedModelInfo(int modelHandle);
+}
+
+/// Optional capability for backends that can export a model's vocabulary as
+/// a [VocabPieceTable] for detokenizing without backend calls.
+abstract class LlamaVocabBackend {
+  /// Returns the piece table of [modelHandle].
+  Future<VocabPieceTable> vocabPieceTable(int modelHandle);
+}
+
+/// Optional capability for backends that tokenize many texts per call,
+/// spreading large batches over parallel tokenizer threads.
+abstract class LlamaBatchTokenizerBackend {
+  /// Tokenizes every text in [texts].
+  ///
+  /// [threads] caps the number of tokenizer threads; `null` uses all
+  /// logical CPUs.
+  Future<TokenBatch> tokenizeBatch(
+    int modelHandle,
+    List<String> texts, {
+    bool addSpecial = true,
+    int? threads,
+  });
+
+  /// Counts the tokens of every text in [texts] without returning them.
+  Future<Int32List> countTokensBatch(
+    int modelHandle,
+    List<String> texts, {
+    bool addSpecial = true,
+    int? threads,
+  });
+}
+
+/// Optional capability for backends that can quantize GGUF models on the
+/// device.
+abstract class LlamaQuantizationBackend {
+  /// Converts the model at [inputPath] to the quantization described by
+  /// [params] and writes it to [outputPath].
+  ///
+  /// [onProgress] receives fractions in `[0.0, 1.0]`. A running job fails
+  /// with an exception after [cancelQuantization].
+  Future<void> quantizeModel(
+    String inputPath,
+    String outputPath,
+    QuantizationParams params, {
+    Function(double progress)? onProgress,
+  });
+
+  /// Cancels every running [quantizeModel] and [quantizeModelToFit] job.
+  void cancelQuantization();
+
+  /// Returns a path to the model at [path] that fits [budget].
+  ///
+  /// Picks the highest-quality quantization that fits, produces it once in
+  /// the backend's cache, and returns [path] itself when the model already
+  /// fits. Throws when no quantization fits.
+  Future<String> quantizeModelToFit(
+    String path,
+    QuantizationBudget budget, {
+    Function(double progress)? onProgress,
+  });
+}
+
+/// Optional capability for backends that load URL models by first
+/// downloading them to local storage.
+abstract class LlamaModelDownloadBackend {
+  /// Downloads the model at [url] into the backend's model cache and returns
+  /// the local path.
+  ///
+  /// Interrupted downloads resume on the next call. When [sha256] is given
+  /// the file is verified before the path is returned.
+  Future<String> downloadModel(
+    String url, {
+    String? sha256,
+    Function(double progress)? onProgress,
+  });
+}
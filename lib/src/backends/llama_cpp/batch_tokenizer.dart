@@ -0,0 +1,314 @@
+import 'dart:convert';
+import 'dart:ffi';
+import 'dart:typed_data';
+
+import 'package:ffi/ffi.dart';
+
+import '../../core/vocab/token_batch.dart';
+import 'bindings.dart';
+import 'off_worker.dart';
+
+/// Batches shorter than this many UTF-16 code units per shard are tokenized
+/// inline; an isolate hop costs more than the work it would offload.
+const int minTokenizerShardLength = 64 * 1024;
+
+/// Splits [texts] into at most [threads] contiguous shards of similar total
+/// length and returns the shard boundaries, starting with 0 and ending with
+/// `texts.length`.
+List<int> tokenizerShardBounds(
+  List<String> texts,
+  int threads, {
+  int minShardLength = minTokenizerShardLength,
+}) {
+  var total = 0;
+  for (final text in texts) {
+    total += text.length;
+  }
+  var shards = threads < 1 ? 1 : threads;
+  final byLength = total ~/ (minShardLength < 1 ? 1 : minShardLength);
+  if (byLength < shards) shards = byLength < 1 ? 1 : byLength;
+  if (shards > texts.length && texts.isNotEmpty) shards = texts.length;
+
+  final bounds = <int>[0];
+  var consumed = 0;
+  for (var i = 0; i < texts.length && bounds.length < shards; i++) {
+    consumed += texts[i].length;
+    if (consumed * shards >= total * bounds.length) bounds.add(i + 1);
+  }
+  if (bounds.last != texts.length) bounds.add(texts.length);
+  return bounds;
+}
+
+/// Tokenizes [texts] with the vocabulary at [vocabAddress], splitting the
+/// work over up to [threads] helper isolates.
+///
+/// llama.cpp tokenization only reads the vocabulary, so shards run
+/// concurrently against the same model. The model must stay alive until the
+/// returned future completes. Texts that already start with [bosText] do not
+/// get a second BOS token.
+Future<TokenBatch> tokenizeTextsInParallel(
+  int vocabAddress,
+  List<String> texts, {
+  required bool addSpecial,
+  required int threads,
+  String? bosText,
+}) async {
+  final bounds = tokenizerShardBounds(texts, threads);
+  if (bounds.length <= 2 && !_worthOffloading(texts)) {
+    return tokenizeTexts(
+      vocabAddress,
+      texts,
+      addSpecial: addSpecial,
+      bosText: bosText,
+    );
+  }
+  final shards = await Future.wait([
+    for (var s = 0; s + 1 < bounds.length; s++)
+      _tokenizeShard(
+        vocabAddress,
+        texts.sublist(bounds[s], bounds[s + 1]),
+        addSpecial,
+        bosText,
+      ),
+  ]);
+  return TokenBatch.concat(shards);
+}
+
+/// Counts the tokens of [texts] like [tokenizeTextsInParallel], without
+/// materializing token IDs.
+Future<Int32List> countTokensInParallel(
+  int vocabAddress,
+  List<String> texts, {
+  required bool addSpecial,
+  required int threads,
+  String? bosText,
+}) async {
+  final bounds = tokenizerShardBounds(texts, threads);
+  if (bounds.length <= 2 && !_worthOffloading(texts)) {
+    return countTokens(
+      vocabAddress,
+      texts,
+      addSpecial: addSpecial,
+      bosText: bosText,
+    );
+  }
+  final shards = await Future.wait([
+    for (var s = 0; s + 1 < bounds.length; s++)
+      _countShard(
+        vocabAddress,
+        texts.sublist(bounds[s], bounds[s + 1]),
+        addSpecial,
+        bosText,
+      ),
+  ]);
+  if (shards.length == 1) return shards.single;
+  final counts = Int32List(texts.length);
+  var position = 0;
+  for (final shard in shards) {
+    counts.setAll(position, shard);
+    position += shard.length;
+  }
+  return counts;
+}
+
+/// Tokenizes [texts] on the calling isolate.
+TokenBatch tokenizeTexts(
+  int vocabAddress,
+  List<String> texts, {
+  required bool addSpecial,
+  String? bosText,
+}) {
+  final vocab = Pointer<llama_vocab>.fromAddress(vocabAddress);
+  final scratch = _TokenizerScratch();
+  final offsets = Uint32List(texts.length + 1);
+  var tokens = Int32List(texts.isEmpty ? 0 : 1024);
+  var length = 0;
+  try {
+    for (var i = 0; i < texts.length; i++) {
+      final text = texts[i];
+      final n = scratch.tokenize(
+        vocab,
+        text,
+        addSpecial && !startsWithBosText(text, bosText),
+      );
+      if (length + n > tokens.length) {
+        var capacity = tokens.length * 2;
+        while (capacity < length + n) {
+          capacity *= 2;
+        }
+        tokens = Int32List(capacity)..setRange(0, length, tokens);
+      }
+      tokens.setRange(length, length + n, scratch.tokens.asTypedList(n));
+      length += n;
+      offsets[i + 1] = length;
+    }
+  } finally {
+    scratch.dispose();
+  }
+  return TokenBatch(
+    tokens: length == tokens.length ? tokens : tokens.sublist(0, length),
+    offsets: offsets,
+  );
+}
+
+/// Counts the tokens of [texts] on the calling isolate.
+Int32List countTokens(
+  int vocabAddress,
+  List<String> texts, {
+  required bool addSpecial,
+  String? bosText,
+}) {
+  final vocab = Pointer<llama_vocab>.fromAddress(vocabAddress);
+  final scratch = _TokenizerScratch();
+  final counts = Int32List(texts.length);
+  try {
+    for (var i = 0; i < texts.length; i++) {
+      final text = texts[i];
+      counts[i] = scratch.count(
+        vocab,
+        text,
+        addSpecial && !startsWithBosText(text, bosText),
+      );
+    }
+  } finally {
+    scratch.dispose();
+  }
+  return counts;
+}
+
+/// Whether [text] already begins with the BOS token text [bosText].
+bool startsWithBosText(String text, String? bosText) {
+  if (bosText == null || bosText.isEmpty) return false;
+  return text.trimLeft().startsWith(bosText);
+}
+
+bool _worthOffloading(List<String> texts) {
+  var total = 0;
+  for (final text in texts) {
+    total += text.length;
+    if (total >= minTokenizerShardLength) return true;
+  }
+  return false;
+}
+
+// Each helper only captures its own arguments, so the closure sent to the
+// helper isolate carries a shard of texts and nothing else.
+Future<TokenBatch> _tokenizeShard(
+  int vocabAddress,
+  List<String> texts,
+  bool addSpecial,
+  String? bosText,
+) {
+  TokenBatch run() => tokenizeTexts(
+    vocabAddress,
+    texts,
+    addSpecial: addSpecial,
+    bosText: bosText,
+  );
+
+  // Inline only if no helper isolate can be spawned; tokenization failures
+  // propagate instead of running again on the inference worker.
+  return runOffWorker(run);
+}
+
+Future<Int32List> _countShard(
+  int vocabAddress,
+  List<String> texts,
+  bool addSpecial,
+  String? bosText,
+) {
+  Int32List run() => countTokens(
+    vocabAddress,
+    texts,
+    addSpecial: addSpecial,
+    bosText: bosText,
+  );
+
+  return runOffWorker(run);
+}
+
+/// Native buffers reused across the texts of one shard.
+class _TokenizerScratch {
+  Pointer<Uint8> _text = nullptr;
+  int _textCapacity = 0;
+  Pointer<Int32> tokens = nullptr;
+  int _tokenCapacity = 0;
+
+  /// Tokenizes [text] into [tokens] and returns the token count.
+  ///
+  /// The buffer is sized from the UTF-8 length, which bounds the token count
+  /// for every llama.cpp tokenizer apart from added special tokens, so the
+  /// second `llama_tokenize` call is only needed in rare cases.
+  int tokenize(Pointer<llama_vocab> vocab, String text, bool addSpecial) {
+    final length = _encode(text);
+    _ensureTokens(length + 8);
+    var n = llama_tokenize(
+      vocab,
+      _text.cast(),
+      length,
+      tokens,
+      _tokenCapacity,
+      addSpecial,
+      true,
+    );
+    if (n < 0) {
+      _ensureTokens(-n);
+      n = llama_tokenize(
+        vocab,
+        _text.cast(),
+        length,
+        tokens,
+        _tokenCapacity,
+        addSpecial,
+        true,
+      );
+    }
+    if (n < 0) {
+      throw Exception("Tokenization failed");
+    }
+    return n;
+  }
+
+  /// Returns the token count of [text] without storing tokens.
+  int count(Pointer<llama_vocab> vocab, String text, bool addSpecial) {
+    final length = _encode(text);
+    // With no output space llama_tokenize reports the count as negative.
+    final n = llama_tokenize(
+      vocab,
+      _text.cast(),
+      length,
+      nullptr,
+      0,
+      addSpecial,
+      true,
+    );
+    return n < 0 ? -n : n;
+  }
+
+  int _encode(String text) {
+    final bytes = utf8.encode(text);
+    if (_text == nullptr || bytes.length > _textCapacity) {
+      if (_text != nullptr) malloc.free(_text);
+      _textCapacity = bytes.length < 4096 ? 4096 : bytes.length;
+      _text = malloc<Uint8>(_textCapacity);
+    }
+    if (bytes.isNotEmpty) {
+      _text.asTypedList(bytes.length).setAll(0, bytes);
+    }
+    return bytes.length;
+  }
+
+  void _ensureTokens(int capacity) {
+    if (capacity <= _tokenCapacity) return;
+    if (tokens != nullptr) malloc.free(tokens);
+    _tokenCapacity = capacity < 1024 ? 1024 : capacity;
+    tokens = malloc<Int32>(_tokenCapacity);
+  }
+
+  void dispose() {
+    if (_text != nullptr) malloc.free(_text);
+    if (tokens != nullptr) malloc.free(tokens);
+    _text = nullptr;
+    tokens = nullptr;
+  }
+}
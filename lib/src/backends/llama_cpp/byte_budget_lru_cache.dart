@@ -0,0 +1,133 @@
+import 'dart:collection';
+
+class _LruCacheEntry<V> {
+  final V value;
+  final int bytes;
+  int pins = 0;
+  bool detached = false;
+
+  _LruCacheEntry(this.value, this.bytes);
+}
+
+/// A pinned cache value; see [ByteBudgetLruCache.acquire].
+class CacheLease<V> {
+  final ByteBudgetLruCache<V> _cache;
+  final _LruCacheEntry<V> _entry;
+  bool _released = false;
+
+  CacheLease._(this._cache, this._entry);
+
+  /// The pinned value.
+  V get value => _entry.value;
+
+  /// Unpins the value. Releasing twice has no effect.
+  void release() {
+    if (_released) return;
+    _released = true;
+    _cache._unpin(_entry);
+  }
+}
+
+/// Least-recently-used cache bounded by entry count and byte size.
+///
+/// Eviction is deferred to [trim] so values handed out for the current
+/// request stay alive until the caller is done with them. Values that must
+/// outlive an `await` are pinned with [acquire]: pinned entries are skipped
+/// by [trim], and pinned values that are replaced or cleared are released
+/// only when their last lease is.
+class ByteBudgetLruCache<V> {
+  /// Maximum number of retained entries.
+  final int maxEntries;
+
+  /// Maximum number of retained bytes.
+  final int maxBytes;
+
+  final void Function(V value) _onEvict;
+  final LinkedHashMap<String, _LruCacheEntry<V>> _entries =
+      LinkedHashMap<String, _LruCacheEntry<V>>();
+  int _totalBytes = 0;
+
+  /// Creates a cache that calls [onEvict] for every dropped value.
+  ByteBudgetLruCache({
+    required this.maxEntries,
+    required this.maxBytes,
+    required void Function(V value) onEvict,
+  }) : _onEvict = onEvict;
+
+  /// Number of cached entries.
+  int get length => _entries.length;
+
+  /// Sum of the byte sizes of cached entries.
+  int get totalBytes => _totalBytes;
+
+  /// Returns the value for [key] and marks it most recently used.
+  V? get(String key) => _touch(key)?.value;
+
+  /// Pins the value for [key] and marks it most recently used, or returns
+  /// `null` when [key] is not cached.
+  CacheLease<V>? acquire(String key) {
+    final entry = _touch(key);
+    if (entry == null) return null;
+    entry.pins++;
+    return CacheLease<V>._(this, entry);
+  }
+
+  /// Inserts [value] under [key], releasing any value it replaces.
+  void put(String key, V value, int bytes) {
+    final previous = _entries.remove(key);
+    if (previous != null) {
+      _totalBytes -= previous.bytes;
+      if (!identical(previous.value, value)) {
+        _detach(previous);
+      }
+    }
+    _entries[key] = _LruCacheEntry<V>(value, bytes);
+    _totalBytes += bytes;
+  }
+
+  /// Evicts least-recently-used unpinned entries until within both budgets
+  /// or only pinned entries remain.
+  void trim() {
+    if (_withinBudget) return;
+    for (final key in _entries.keys.toList(growable: false)) {
+      if (_withinBudget) return;
+      final entry = _entries[key]!;
+      if (entry.pins > 0) continue;
+      _entries.remove(key);
+      _totalBytes -= entry.bytes;
+      _onEvict(entry.value);
+    }
+  }
+
+  /// Evicts every entry; pinned values are released with their last lease.
+  void clear() {
+    final entries = _entries.values.toList(growable: false);
+    _entries.clear();
+    _totalBytes = 0;
+    for (final entry in entries) {
+      _detach(entry);
+    }
+  }
+
+  bool get _withinBudget =>
+      _entries.length <= maxEntries && _totalBytes <= maxBytes;
+
+  _LruCacheEntry<V>? _touch(String key) {
+    final entry = _entries.remove(key);
+    if (entry == null) {
+      return null;
+    }
+    _entries[key] = entry;
+    return entry;
+  }
+
+  void _detach(_LruCacheEntry<V> entry) {
+    entry.detached = true;
+    if (entry.pins == 0) _onEvict(entry.value);
+  }
+
+  void _unpin(_LruCacheEntry<V> entry) {
+    entry.pins--;
+    if (entry.pins == 0 && entry.detached) _onEvict(entry.value);
+  }
+}
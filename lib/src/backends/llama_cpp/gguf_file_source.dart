@@ -0,0 +1,39 @@
+import 'dart:io';
+import 'dart:typed_data';
+
+import '../../core/gguf/gguf_model_info.dart';
+import '../../core/gguf/gguf_reader.dart';
+
+/// [GgufByteSource] that reads ranges of a file on demand.
+class GgufFileSource implements GgufByteSource {
+  final RandomAccessFile _file;
+  final int _length;
+
+  /// Creates a source over an open [file]. The caller owns [file].
+  GgufFileSource(RandomAccessFile file)
+    : _file = file,
+      _length = file.lengthSync();
+
+  @override
+  int get length => _length;
+
+  @override
+  Uint8List read(int offset, int length) {
+    _file.setPositionSync(offset);
+    return _file.readSync(length);
+  }
+}
+
+/// Reads the header, metadata and tensor table of the GGUF file at [path]
+/// without loading weights.
+///
+/// Throws a [FormatException] when the file is not GGUF and a
+/// [FileSystemException] when it cannot be read.
+GgufModelInfo inspectGgufFile(String path) {
+  final file = File(path).openSync();
+  try {
+    return GgufReader.parse(GgufFileSource(file));
+  } finally {
+    file.closeSync();
+  }
+}
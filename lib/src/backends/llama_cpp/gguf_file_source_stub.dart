@@ -0,0 +1,8 @@
+// coverage:ignore-file
+// Stub for web platforms where local files cannot be read synchronously.
+import '../../core/gguf/gguf_model_info.dart';
+
+/// Unsupported on web; parse downloaded bytes with `GgufReader.parseBytes`.
+GgufModelInfo inspectGgufFile(String path) {
+  throw UnsupportedError('inspectGgufFile is not supported on web');
+}
@@ -1,24 +1,53 @@
 import 'dart:async';
+import 'dart:io';
 import 'dart:isolate';
+import 'dart:typed_data';
 import 'dart:ffi';
 import 'package:ffi/ffi.dart';
+import 'package:path/path.dart' as path;
 import '../backend.dart';
+import '../../core/gguf/gguf_model_info.dart';
 import '../../core/models/chat/content_part.dart';
 import '../../core/models/config/log_level.dart';
 import '../../core/models/inference/model_params.dart';
 import '../../core/models/inference/generation_params.dart';
+import '../../core/models/inference/lora_switch_stats.dart';
+import '../../core/models/inference/prompt_lookup_stats.dart';
+import '../../core/quantization/quantization_params.dart';
+import '../../core/quantization/quantization_planner.dart';
+import '../../core/vocab/token_batch.dart';
+import '../../core/vocab/vocab_piece_table.dart';
+import 'gguf_file_source.dart';
+import 'model_downloader.dart';
+import 'model_quantizer.dart';
+import 'native_cache_directory.dart';
 import 'worker.dart';
 
 /// Creates a [NativeLlamaBackend].
 LlamaBackend createBackend() => NativeLlamaBackend();
 
 /// Native implementation of [LlamaBackend] using isolates and FFI.
-class NativeLlamaBackend implements LlamaBackend {
+class NativeLlamaBackend
+    implements
+        LlamaBackend,
+        LlamaLoraStatsBackend,
+        LlamaPromptLookupBackend,
+        LlamaModelInspectionBackend,
+        LlamaModelDownloadBackend,
+        LlamaVocabBackend,
+        LlamaBatchTokenizerBackend,
+        LlamaQuantizationBackend {
   Isolate? _isolate;
   SendPort? _sendPort;
   final ReceivePort _responsesPort = ReceivePort();
   Pointer<Int8>? _activeCancelToken;
 
+  /// Cancel flags of running quantization jobs, one per job.
+  final Set<Pointer<Int8>> _quantizeCancelTokens = {};
+
+  /// GGUF headers parsed by the worker while loading, keyed by model handle.
+  final Map<int, GgufModelInfo> _loadedModelInfo = {};
+
   bool _isReady = false;
   LlamaLogLevel _currentLogLevel = LlamaLogLevel.warn;
 
@@ -87,7 +116,11 @@ class NativeLlamaBackend implements LlamaBackend {
     _sendPort!.send(ModelLoadRequest(path, params, rp.sendPort));
     final res = await rp.first;
     rp.close();
-    if (res is HandleResponse) return res.handle;
+    if (res is ModelLoadResponse) {
+      final modelInfo = res.modelInfo;
+      if (modelInfo != null) _loadedModelInfo[res.handle] = modelInfo;
+      return res.handle;
+    }
     if (res is ErrorResponse) throw Exception(res.message);
     throw Exception("Unknown response during model load");
   }
@@ -98,11 +131,126 @@ class NativeLlamaBackend implements LlamaBackend {
     ModelParams params, {
     Function(double progress)? onProgress,
   }) async {
-    throw UnimplementedError("Use modelLoad with a local path for now");
+    final localPath = await downloadModel(url, onProgress: onProgress);
+    return modelLoad(localPath, params);
+  }
+
+  @override
+  Future<String> downloadModel(
+    String url, {
+    String? sha256,
+    Function(double progress)? onProgress,
+  }) async {
+    final uri = Uri.parse(url);
+    final destination = modelCachePathForUri(
+      path.join(defaultNativeCacheDirectory(), 'models'),
+      uri,
+    );
+    final file = await ModelDownloader().download(
+      uri,
+      destination,
+      sha256: sha256,
+      onProgress: onProgress == null
+          ? null
+          : (progress) {
+              final fraction = progress.fraction;
+              if (fraction != null) onProgress(fraction);
+            },
+    );
+    return file.path;
+  }
+
+  @override
+  Future<void> quantizeModel(
+    String inputPath,
+    String outputPath,
+    QuantizationParams params, {
+    Function(double progress)? onProgress,
+  }) async {
+    await _ensureIsolate();
+    final cancelToken = malloc<Int8>(1);
+    cancelToken.value = 0;
+    _quantizeCancelTokens.add(cancelToken);
+    final rp = ReceivePort();
+    _sendPort!.send(
+      QuantizeRequest(
+        inputPath,
+        outputPath,
+        params,
+        cancelToken.address,
+        rp.sendPort,
+      ),
+    );
+    try {
+      await for (final msg in rp) {
+        if (msg is QuantizeProgressResponse) {
+          onProgress?.call(msg.progress);
+        } else if (msg is DoneResponse) {
+          return;
+        } else if (msg is ErrorResponse) {
+          throw Exception(msg.message);
+        }
+      }
+    } finally {
+      rp.close();
+      // The worker stops reading the flag before it replies.
+      _quantizeCancelTokens.remove(cancelToken);
+      malloc.free(cancelToken);
+    }
+  }
+
+  @override
+  void cancelQuantization() {
+    for (final token in _quantizeCancelTokens) {
+      token.value = 1;
+    }
+  }
+
+  @override
+  Future<String> quantizeModelToFit(
+    String path,
+    QuantizationBudget budget, {
+    Function(double progress)? onProgress,
+  }) async {
+    final source = await inspectModel(path);
+    final fit = pickQuantizationToFit(source, budget);
+    if (fit == null) {
+      throw Exception("No quantization of $path fits the memory budget");
+    }
+    final params = fit.params;
+    if (params == null) {
+      onProgress?.call(1.0);
+      return path;
+    }
+
+    final stat = File(path).statSync();
+    final outputPath = quantizedModelCachePath(
+      defaultNativeCacheDirectory(),
+      path,
+      stat.size,
+      stat.modified.microsecondsSinceEpoch,
+      params.type,
+    );
+    if (await _isCompleteModel(outputPath)) {
+      onProgress?.call(1.0);
+      return outputPath;
+    }
+    await quantizeModel(path, outputPath, params, onProgress: onProgress);
+    return outputPath;
+  }
+
+  Future<bool> _isCompleteModel(String path) async {
+    if (!File(path).existsSync()) return false;
+    try {
+      return (await inspectModel(path)).isComplete;
+    } catch (_) {
+      return false;
+    }
   }
 
   @override
   Future<void> modelFree(int modelHandle) async {
+    _loadedModelInfo.remove(modelHandle);
     if (_sendPort == null) return;
     final rp = ReceivePort();
     _sendPort!.send(ModelFreeRequest(modelHandle, rp.sendPort));
@@ -207,6 +355,73 @@ class NativeLlamaBackend implements LlamaBackend {
     throw Exception("Tokenization failed");
   }
 
+  @override
+  Future<TokenBatch> tokenizeBatch(
+    int modelHandle,
+    List<String> texts, {
+    bool addSpecial = true,
+    int? threads,
+  }) async {
+    final res = await _tokenizeBatch(
+      modelHandle,
+      texts,
+      addSpecial,
+      false,
+      threads,
+    );
+    if (res is! TokenizeBatchResponse) {
+      throw Exception("Batch tokenization failed");
+    }
+    return TokenBatch(
+      tokens: res.tokens.materialize().asInt32List(),
+      offsets: res.offsets.materialize().asUint32List(),
+    );
+  }
+
+  @override
+  Future<Int32List> countTokensBatch(
+    int modelHandle,
+    List<String> texts, {
+    bool addSpecial = true,
+    int? threads,
+  }) async {
+    final res = await _tokenizeBatch(
+      modelHandle,
+      texts,
+      addSpecial,
+      true,
+      threads,
+    );
+    if (res is! TokenCountBatchResponse) {
+      throw Exception("Batch token counting failed");
+    }
+    return res.counts.materialize().asInt32List();
+  }
+
+  Future<Object?> _tokenizeBatch(
+    int modelHandle,
+    List<String> texts,
+    bool addSpecial,
+    bool countOnly,
+    int? threads,
+  ) async {
+    final rp = ReceivePort();
+    _sendPort!.send(
+      TokenizeBatchRequest(
+        modelHandle,
+        texts,
+        addSpecial,
+        countOnly,
+        threads,
+        rp.sendPort,
+      ),
+    );
+    final res = await rp.first;
+    rp.close();
+    if (res is ErrorResponse) throw Exception(res.message);
+    return res;
+  }
+
   @override
   Future<String> detokenize(
     int modelHandle,
@@ -274,6 +489,55 @@ class NativeLlamaBackend implements LlamaBackend {
     if (res is ErrorResponse) throw Exception(res.message);
   }
 
+  @override
+  Future<GgufModelInfo> inspectModel(String path) {
+    // Parsing only touches metadata pages, but keep file I/O off the caller's
+    // isolate so catalog scans do not stall the UI.
+    return Isolate.run(() => inspectGgufFile(path));
+  }
+
+  @override
+  GgufModelInfo? loadedModelInfo(int modelHandle) =>
+      _loadedModelInfo[modelHandle];
+
+  @override
+  Future<VocabPieceTable> vocabPieceTable(int modelHandle) async {
+    await _ensureIsolate();
+    final rp = ReceivePort();
+    _sendPort!.send(VocabPieceTableRequest(modelHandle, rp.sendPort));
+    final res = await rp.first;
+    rp.close();
+    if (res is ErrorResponse) throw Exception(res.message);
+    final table = res as VocabPieceTableResponse;
+    return VocabPieceTable(
+      bytes: table.bytes.materialize().asUint8List(),
+      offsets: table.offsets.materialize().asUint32List(),
+      flags: table.flags.materialize().asUint8List(),
+    );
+  }
+
+  @override
+  Future<LoraSwitchStats> loraSwitchStats(int contextHandle) async {
+    if (_sendPort == null) return const LoraSwitchStats();
+    final rp = ReceivePort();
+    _sendPort!.send(LoraStatsRequest(contextHandle, rp.sendPort));
+    final res = await rp.first;
+    rp.close();
+    if (res is ErrorResponse) throw Exception(res.message);
+    return (res as LoraStatsResponse).stats;
+  }
+
+  @override
+  Future<PromptLookupStats> promptLookupStats(int contextHandle) async {
+    if (_sendPort == null) return const PromptLookupStats();
+    final rp = ReceivePort();
+    _sendPort!.send(PromptLookupStatsRequest(contextHandle, rp.sendPort));
+    final res = await rp.first;
+    rp.close();
+    if (res is ErrorResponse) throw Exception(res.message);
+    return (res as PromptLookupStatsResponse).stats;
+  }
+
   @override
   Future<String> getBackendName() async {
     await _ensureIsolate();
@@ -312,6 +576,7 @@ class NativeLlamaBackend implements LlamaBackend {
     // Do NOT free _activeCancelToken here; it is freed by the generate listener
     // or leaked if isolate dies immediately (which is safe/acceptable).
     _activeCancelToken = null;
+    _loadedModelInfo.clear();
     _isReady = false;
   }
 
@@ -2,16 +2,35 @@ import 'dart:async';
 import 'dart:convert';
 import 'dart:ffi';
 import 'dart:io';
+import 'dart:typed_data';
 
 import 'package:ffi/ffi.dart';
 import 'package:path/path.dart' as path;
 
+import '../../core/gguf/gguf_model_info.dart';
 import '../../core/models/chat/content_part.dart';
 import '../../core/models/config/gpu_backend.dart';
 import '../../core/models/config/log_level.dart';
+import '../../core/models/config/threading_config.dart';
 import '../../core/models/inference/generation_params.dart';
+import '../../core/models/inference/lora_switch_stats.dart';
 import '../../core/models/inference/model_params.dart';
+import '../../core/models/inference/prompt_lookup_stats.dart';
+import '../../core/quantization/quantization_params.dart';
+import '../../core/vocab/token_batch.dart';
+import '../../core/vocab/utf8_assembler.dart';
+import '../../core/vocab/vocab_piece_table.dart';
+import 'batch_tokenizer.dart';
 import 'bindings.dart';
+import 'byte_budget_lru_cache.dart';
+import 'gguf_file_source.dart';
+import 'lora_adapter_sets.dart';
+import 'model_quantizer.dart';
+import 'multimodal_prompt_cache.dart';
+import 'native_cache_directory.dart';
+import 'off_worker.dart';
+import 'prompt_lookup_drafter.dart';
+import 'thread_tuning.dart';
 
 typedef _GgmlBackendLoadNative = ggml_backend_reg_t Function(Pointer<Char>);
 typedef _GgmlBackendLoadDart = ggml_backend_reg_t Function(Pointer<Char>);
@@ -109,6 +128,15 @@ typedef _MtmdHelperEvalChunksDart =
     );
 typedef _MtmdLogSetNative = Void Function(ggml_log_callback, Pointer<Void>);
 typedef _MtmdLogSetDart = void Function(ggml_log_callback, Pointer<Void>);
+typedef _GgmlThreadpoolNewNative =
+    ggml_threadpool_t Function(Pointer<ggml_threadpool_params>);
+typedef _GgmlThreadpoolNewDart =
+    ggml_threadpool_t Function(Pointer<ggml_threadpool_params>);
+typedef _GgmlThreadpoolFreeNative = Void Function(ggml_threadpool_t);
+typedef _GgmlThreadpoolFreeDart = void Function(ggml_threadpool_t);
+
+/// Size of `ggml_threadpool_params.cpumask` (`GGML_MAX_N_THREADS`).
+const int _maxThreadpoolCpus = 512;
 
 /// Service responsible for managing Llama.cpp models and contexts.
 ///
@@ -150,12 +178,26 @@ class LlamaCppService {
   final Map<int, llama_batch> _batches = {};
   final Map<int, llama_context_params> _contextParams = {};
   final Map<int, Map<String, _LlamaLoraWrapper>> _loraAdapters = {};
-  final Map<int, Map<String, double>> _activeLoras = {};
+  final Map<int, LoraAdapterSets> _loraSets = {};
+  final Map<int, _ContextThreadpools> _threadpools = {};
+  final Map<String, ThreadTuningResult> _threadTunings = {};
+  bool _threadpoolLookupAttempted = false;
+  _GgmlThreadpoolApi? _threadpoolApi;
+  bool _numaInitialized = false;
 
   // Mapping: modelHandle -> mtmdContextHandle
   final Map<int, int> _modelToMtmd = {};
   final Map<int, Pointer<mtmd_context>> _mtmdContexts = {};
 
+  /// Number of requests decoding media with each projector. Frees arriving
+  /// meanwhile are parked in [_deferredMtmdFrees] until the count drops to 0.
+  final Map<int, int> _mtmdPins = {};
+  final Map<int, void Function()> _deferredMtmdFrees = {};
+
+  // Mapping: mtmdContextHandle -> decoded bitmaps and projector outputs
+  final Map<int, _MultimodalMediaCache> _mtmdMediaCaches = {};
+  int _anonymousMediaSerial = 0;
+
   int _getHandle() => _nextHandle++;
 
   /// Resolves the effective GPU layer count for model loading.
@@ -829,9 +871,25 @@ class LlamaCppService {
         "Please verify the download completed correctly.",
       );
     }
+    // The header inspector only adds metadata and a truncation check; when it
+    // cannot parse a file, llama.cpp stays the judge of whether it loads.
+    GgufModelInfo? ggufInfo;
+    try {
+      ggufInfo = inspectGgufFile(modelPath);
+    } catch (_) {
+      ggufInfo = null;
+    }
+    if (ggufInfo != null && !ggufInfo.isComplete) {
+      throw Exception(
+        "Model file is truncated: $modelPath (size=$modelFileSize bytes, "
+        "expected at least ${ggufInfo.dataOffset + ggufInfo.tensorBytes}). "
+        "Please verify the download completed correctly.",
+      );
+    }
 
     _applyConfiguredLogLevel();
     _prepareBackendsForModelLoad(modelParams.preferredBackend);
+    _initializeNuma(modelParams.threading.numa);
 
     final modelPathPtr = modelPath.toNativeUtf8();
     final mparams = llama_model_default_params();
@@ -875,7 +933,7 @@ class LlamaCppService {
     }
 
     final handle = _getHandle();
-    _models[handle] = _LlamaModelWrapper(modelPtr);
+    _models[handle] = _LlamaModelWrapper(modelPtr, ggufInfo);
     _loraAdapters[handle] = {};
 
     return handle;
@@ -1573,12 +1631,9 @@ class LlamaCppService {
 
       // Free associated multimodal context
       final mmHandle = _modelToMtmd.remove(modelHandle);
-      if (mmHandle != null) {
-        final mmCtx = _mtmdContexts.remove(mmHandle);
-        if (mmCtx != null) _mtmdFree(mmCtx);
-      }
+      if (mmHandle != null) _disposeMultimodalContext(mmHandle);
 
-      model.dispose();
+      model.release();
     }
   }
 
@@ -1609,18 +1664,346 @@ class LlamaCppService {
     }
 
     final handle = _getHandle();
-    _contexts[handle] = _LlamaContextWrapper(ctxPtr, model);
+    _contexts[handle] = _LlamaContextWrapper(
+      ctxPtr,
+      model,
+      params.loraSnapshotBytes,
+    );
     _contextToModel[handle] = modelHandle;
-    _activeLoras[handle] = {};
+    _loraSets[handle] = LoraAdapterSets();
     _contextParams[handle] = ctxParams;
     _samplers[handle] = llama_sampler_chain_init(
       llama_sampler_chain_default_params(),
     );
     _batches[handle] = llama_batch_init(nCtx, 0, 1);
 
+    _configureContextThreads(handle, model, ctxPtr, params);
+
     return handle;
   }
 
+  void _initializeNuma(NumaStrategy strategy) {
+    if (strategy == NumaStrategy.disabled || _numaInitialized) {
+      return;
+    }
+    final native = switch (strategy) {
+      NumaStrategy.disabled => ggml_numa_strategy.GGML_NUMA_STRATEGY_DISABLED,
+      NumaStrategy.distribute =>
+        ggml_numa_strategy.GGML_NUMA_STRATEGY_DISTRIBUTE,
+      NumaStrategy.isolate => ggml_numa_strategy.GGML_NUMA_STRATEGY_ISOLATE,
+      NumaStrategy.numactl => ggml_numa_strategy.GGML_NUMA_STRATEGY_NUMACTL,
+      NumaStrategy.mirror => ggml_numa_strategy.GGML_NUMA_STRATEGY_MIRROR,
+    };
+    try {
+      llama_numa_init(native);
+      _numaInitialized = true;
+    } on ArgumentError {
+      // Symbol unavailable in this bundle; keep default placement.
+    }
+  }
+
+  /// Applies thread autotuning and persistent threadpools to a new context.
+  void _configureContextThreads(
+    int contextHandle,
+    _LlamaModelWrapper model,
+    Pointer<llama_context> ctxPtr,
+    ModelParams params,
+  ) {
+    final threading = params.threading;
+    var decodeThreads = params.numberOfThreads;
+    var batchThreads = params.numberOfThreadsBatch;
+
+    if (threading.autotune && (decodeThreads <= 0 || batchThreads <= 0)) {
+      final tuned = _resolveThreadTuning(
+        model,
+        ctxPtr,
+        _batches[contextHandle]!,
+        params,
+      );
+      if (tuned != null) {
+        if (decodeThreads <= 0) decodeThreads = tuned.decodeThreads;
+        if (batchThreads <= 0) batchThreads = tuned.batchThreads;
+      }
+    }
+
+    if (decodeThreads <= 0) decodeThreads = llama_n_threads(ctxPtr);
+    if (batchThreads <= 0) batchThreads = llama_n_threads_batch(ctxPtr);
+    llama_set_n_threads(ctxPtr, decodeThreads, batchThreads);
+    final ctxParams = _contextParams[contextHandle]!;
+    ctxParams.n_threads = decodeThreads;
+    ctxParams.n_threads_batch = batchThreads;
+
+    if (threading.persistentThreadpool) {
+      final pools = _createThreadpools(decodeThreads, batchThreads, threading);
+      if (pools != null) {
+        llama_attach_threadpool(ctxPtr, pools.decode, pools.batch);
+        _threadpools[contextHandle] = pools;
+      }
+    }
+  }
+
+  ThreadTuningResult? _resolveThreadTuning(
+    _LlamaModelWrapper model,
+    Pointer<llama_context> ctxPtr,
+    llama_batch batch,
+    ModelParams params,
+  ) {
+    final key = threadTuningCacheKey(
+      host: Platform.localHostname,
+      logicalCpus: Platform.numberOfProcessors,
+      modelDescription: _modelDescription(model.pointer),
+      modelSizeBytes: llama_model_size(model.pointer),
+      gpuLayers: resolveGpuLayersForLoad(params),
+    );
+    final remembered = _threadTunings[key];
+    if (remembered != null) return remembered;
+
+    final cache = ThreadTuningCache(
+      File(
+        path.join(
+          params.threading.tuningCacheDirectory ??
+              defaultNativeCacheDirectory(),
+          'thread_tuning.json',
+        ),
+      ),
+    );
+    var result = cache.lookup(key);
+    if (result == null) {
+      try {
+        result = _calibrateThreads(model.pointer, ctxPtr, batch);
+      } on Exception {
+        _clearContextMemory(ctxPtr);
+        return null;
+      }
+      if (result == null) return null;
+      cache.store(key, result);
+    }
+    _threadTunings[key] = result;
+    return result;
+  }
+
+  String _modelDescription(Pointer<llama_model> model) {
+    final buf = malloc<Char>(256);
+    try {
+      final length = llama_model_desc(model, buf, 256);
+      if (length <= 0) return '';
+      return buf.cast<Utf8>().toDartString();
+    } finally {
+      malloc.free(buf);
+    }
+  }
+
+  /// Times a short prefill and decode at each candidate thread count and
+  /// returns the fastest count for each phase.
+  ThreadTuningResult? _calibrateThreads(
+    Pointer<llama_model> model,
+    Pointer<llama_context> ctxPtr,
+    llama_batch batch,
+  ) {
+    const maxPrefillTokens = 64;
+    const maxDecodeSteps = 8;
+    final nCtx = llama_n_ctx(ctxPtr);
+    final prefillTokens = nCtx ~/ 2 < maxPrefillTokens
+        ? nCtx ~/ 2
+        : maxPrefillTokens;
+    final decodeSteps = nCtx - prefillTokens < maxDecodeSteps
+        ? nCtx - prefillTokens
+        : maxDecodeSteps;
+    final nVocab = llama_vocab_n_tokens(llama_model_get_vocab(model));
+    if (prefillTokens <= 0 || decodeSteps <= 0 || nVocab <= 0) {
+      return null;
+    }
+
+    final candidates = threadCountCandidates(Platform.numberOfProcessors);
+    // Warm-up pass so page faults on memory-mapped weights are not billed to
+    // the first candidate.
+    _runThreadCalibrationPass(
+      ctxPtr,
+      batch,
+      candidates.last,
+      prefillTokens,
+      decodeSteps,
+      nVocab,
+    );
+
+    final prefillMicros = <int, int>{};
+    final decodeMicros = <int, int>{};
+    for (final threads in candidates) {
+      final timing = _runThreadCalibrationPass(
+        ctxPtr,
+        batch,
+        threads,
+        prefillTokens,
+        decodeSteps,
+        nVocab,
+      );
+      prefillMicros[threads] = timing.prefillMicros;
+      decodeMicros[threads] = timing.decodeMicros;
+    }
+    _clearContextMemory(ctxPtr);
+
+    return ThreadTuningResult(
+      decodeThreads: fastestThreadCount(decodeMicros),
+      batchThreads: fastestThreadCount(prefillMicros),
+    );
+  }
+
+  ({int prefillMicros, int decodeMicros}) _runThreadCalibrationPass(
+    Pointer<llama_context> ctxPtr,
+    llama_batch batch,
+    int threads,
+    int prefillTokens,
+    int decodeSteps,
+    int nVocab,
+  ) {
+    llama_set_n_threads(ctxPtr, threads, threads);
+    _clearContextMemory(ctxPtr);
+
+    // Token values do not affect compute cost; any valid ids will do.
+    int tokenAt(int position) => (position * 7919 + 1) % nVocab;
+
+    batch.n_tokens = prefillTokens;
+    for (var i = 0; i < prefillTokens; i++) {
+      batch.token[i] = tokenAt(i);
+      batch.pos[i] = i;
+      batch.n_seq_id[i] = 1;
+      batch.seq_id[i][0] = 0;
+      batch.logits[i] = (i == prefillTokens - 1) ? 1 : 0;
+    }
+
+    final stopwatch = Stopwatch()..start();
+    if (llama_decode(ctxPtr, batch) != 0) {
+      throw Exception("Thread calibration prefill failed");
+    }
+    llama_synchronize(ctxPtr);
+    final prefillMicros = stopwatch.elapsedMicroseconds;
+
+    stopwatch
+      ..reset()
+      ..start();
+    for (var step = 0; step < decodeSteps; step++) {
+      final position = prefillTokens + step;
+      batch.n_tokens = 1;
+      batch.token[0] = tokenAt(position);
+      batch.pos[0] = position;
+      batch.n_seq_id[0] = 1;
+      batch.seq_id[0][0] = 0;
+      batch.logits[0] = 1;
+      if (llama_decode(ctxPtr, batch) != 0) {
+        throw Exception("Thread calibration decode failed");
+      }
+    }
+    llama_synchronize(ctxPtr);
+
+    return (
+      prefillMicros: prefillMicros,
+      decodeMicros: stopwatch.elapsedMicroseconds,
+    );
+  }
+
+  _GgmlThreadpoolApi? _resolveThreadpoolApi() {
+    if (_threadpoolLookupAttempted) return _threadpoolApi;
+    _threadpoolLookupAttempted = true;
+
+    // The threadpool constructors live in the CPU backend module, which may
+    // be loaded dynamically, so resolve them through its registry entry.
+    final cpuDev = _backendRegistryOr<ggml_backend_dev_t>(
+      nullptr,
+      () => ggml_backend_dev_by_type(
+        ggml_backend_dev_type.GGML_BACKEND_DEVICE_TYPE_CPU,
+      ),
+    );
+    if (cpuDev == nullptr) return null;
+    final reg = _backendRegistryOr<ggml_backend_reg_t>(
+      nullptr,
+      () => ggml_backend_dev_backend_reg(cpuDev),
+    );
+    if (reg == nullptr) return null;
+
+    Pointer<Void> lookup(String name) {
+      final namePtr = name.toNativeUtf8();
+      try {
+        return _backendRegistryOr<Pointer<Void>>(
+          nullptr,
+          () => ggml_backend_reg_get_proc_address(reg, namePtr.cast()),
+        );
+      } finally {
+        malloc.free(namePtr);
+      }
+    }
+
+    final create = lookup('ggml_threadpool_new');
+    final free = lookup('ggml_threadpool_free');
+    if (create == nullptr || free == nullptr) return null;
+
+    return _threadpoolApi = _GgmlThreadpoolApi(
+      create
+          .cast<NativeFunction<_GgmlThreadpoolNewNative>>()
+          .asFunction<_GgmlThreadpoolNewDart>(),
+      free
+          .cast<NativeFunction<_GgmlThreadpoolFreeNative>>()
+          .asFunction<_GgmlThreadpoolFreeDart>(),
+    );
+  }
+
+  /// Creates the decode threadpool and, when prefill uses a different
+  /// configuration, a separate prefill threadpool.
+  _ContextThreadpools? _createThreadpools(
+    int decodeThreads,
+    int batchThreads,
+    ThreadingConfig threading,
+  ) {
+    final api = _resolveThreadpoolApi();
+    if (api == null) return null;
+
+    final decodeParams = malloc<ggml_threadpool_params>();
+    final batchParams = malloc<ggml_threadpool_params>();
+    try {
+      _initThreadpoolParams(decodeParams, decodeThreads, threading);
+      _initThreadpoolParams(batchParams, batchThreads, threading);
+
+      ggml_threadpool_t batchPool = nullptr;
+      if (!ggml_threadpool_params_match(decodeParams, batchParams)) {
+        batchPool = api.create(batchParams);
+        if (batchPool == nullptr) return null;
+        // Only one pool runs at a time; start the decode pool paused so it
+        // does not spin while the prefill pool is busy.
+        decodeParams.ref.paused = true;
+      }
+
+      final decodePool = api.create(decodeParams);
+      if (decodePool == nullptr) {
+        if (batchPool != nullptr) api.free(batchPool);
+        return null;
+      }
+      return _ContextThreadpools(api, decodePool, batchPool);
+    } on ArgumentError {
+      return null;
+    } finally {
+      malloc.free(decodeParams);
+      malloc.free(batchParams);
+    }
+  }
+
+  void _initThreadpoolParams(
+    Pointer<ggml_threadpool_params> params,
+    int threads,
+    ThreadingConfig threading,
+  ) {
+    ggml_threadpool_params_init(params, threads);
+    final ref = params.ref;
+    final poll = threading.pollLevel;
+    ref.poll = poll < 0 ? 0 : (poll > 100 ? 100 : poll);
+    final affinity = threading.cpuAffinity;
+    if (affinity.isEmpty) return;
+    for (final cpu in affinity) {
+      if (cpu >= 0 && cpu < _maxThreadpoolCpus) {
+        ref.cpumask[cpu] = true;
+      }
+    }
+    ref.strict_cpu = threading.strictCpuPlacement;
+  }
+
   /// Frees the context associated with [contextHandle].
   void freeContext(int contextHandle) {
     _freeContext(contextHandle);
@@ -1628,13 +2011,14 @@ class LlamaCppService {
 
   void _freeContext(int handle) {
     _contextToModel.remove(handle);
-    _activeLoras.remove(handle);
+    _loraSets.remove(handle);
     _contextParams.remove(handle);
     final sampler = _samplers.remove(handle);
     if (sampler != null && sampler != nullptr) llama_sampler_free(sampler);
     final batch = _batches.remove(handle);
     if (batch != null) llama_batch_free(batch);
     _contexts.remove(handle)?.dispose();
+    _threadpools.remove(handle)?.dispose();
   }
 
   /// Generates text based on the given [prompt] and [params].
@@ -1655,22 +2039,41 @@ class LlamaCppService {
     final model = _models[modelHandle]!;
     final modelParams = _contextParams[contextHandle]!;
     final vocab = llama_model_get_vocab(model.pointer);
-    final hasMediaParts =
-        parts?.any((p) => p is LlamaImageContent || p is LlamaAudioContent) ??
-        false;
+    final loraSets = _loraSets[contextHandle];
+    if (loraSets != null) {
+      // Requests without their own set go back to the configured adapters,
+      // whatever an earlier request applied.
+      _switchAdapterSet(
+        contextHandle,
+        ctx,
+        modelHandle,
+        loraSets.targetFor(params.loras),
+      );
+    }
+    final mediaParts =
+        parts
+            ?.where((p) => p is LlamaImageContent || p is LlamaAudioContent)
+            .toList(growable: false) ??
+        const <LlamaContentPart>[];
+    final hasMediaParts = mediaParts.isNotEmpty;
+    final mmHandle = _modelToMtmd[modelHandle];
+    final mmCtx = mmHandle != null ? _mtmdContexts[mmHandle] : null;
+    final useMediaCache =
+        hasMediaParts && mmCtx != null && _mtmdMediaCacheAvailable();
 
     // 1. Reset Context
     ctx = _resetContext(
       contextHandle,
       ctx,
-      clearMemory: hasMediaParts || !params.reusePromptPrefix,
+      clearMemory:
+          !params.reusePromptPrefix || (hasMediaParts && !useMediaCache),
     );
 
     // 2. Prepare Resources
     final nCtx = llama_n_ctx(ctx.pointer);
     final batch = _batches[contextHandle]!;
     final tokensPtr = malloc<Int32>(nCtx);
-    final pieceBuf = malloc<Uint8>(256);
+    final pieceTable = _pieceTable(model);
     Pointer<Utf8> grammarPtr = nullptr;
     Pointer<Utf8> rootPtr = nullptr;
     _LazyGrammarConfig? lazyGrammarConfig;
@@ -1683,21 +2086,61 @@ class LlamaCppService {
       }
     }
 
+    // Decoding media awaits helper isolates, during which the worker may
+    // handle free requests: keep the model and projector alive and re-check
+    // the context afterwards.
+    model.retain();
+    if (useMediaCache) _pinMultimodalContext(mmHandle!);
+    List<_PreparedMediaBitmap>? preparedMedia;
     try {
+      if (useMediaCache) {
+        preparedMedia = await _prepareMediaBitmaps(
+          mmHandle!,
+          mmCtx!,
+          mediaParts,
+        );
+        if (!identical(_contexts[contextHandle], ctx) ||
+            _batches[contextHandle] == null ||
+            _mtmdContexts[mmHandle] != mmCtx) {
+          throw Exception(
+            "Context or multimodal projector was freed while media was "
+            "being decoded",
+          );
+        }
+      }
+
       // 3. Ingest Prompt (Text or Multimodal)
-      final initialTokens = _ingestPrompt(
-        contextHandle,
-        modelHandle,
-        ctx,
-        batch,
-        vocab,
-        prompt,
-        parts,
-        tokensPtr,
-        nCtx,
-        modelParams,
-        allowTextPromptReuse: !hasMediaParts && params.reusePromptPrefix,
-      );
+      final initialTokens = preparedMedia != null
+          ? _ingestCachedMultimodalPrompt(
+              mmCtx!,
+              _mtmdMediaCaches[mmHandle]!,
+              ctx,
+              batch,
+              model.pointer,
+              vocab,
+              prompt,
+              preparedMedia,
+              modelParams,
+              allowPromptReuse: params.reusePromptPrefix,
+            )
+          : _ingestPrompt(
+              contextHandle,
+              modelHandle,
+              ctx,
+              batch,
+              vocab,
+              prompt,
+              parts,
+              tokensPtr,
+              nCtx,
+              modelParams,
+              allowTextPromptReuse: !hasMediaParts && params.reusePromptPrefix,
+            );
+      // Bitmaps are only read during ingestion; let the cache evict them.
+      if (preparedMedia != null) {
+        _releaseMediaBitmaps(preparedMedia);
+        preparedMedia = null;
+      }
 
       // 4. Initialize and Run Sampler Loop
       final sampler = _initializeSampler(
@@ -1728,19 +2171,22 @@ class LlamaCppService {
         initialTokens,
         nCtx,
         cancelTokenAddress,
-        pieceBuf,
+        pieceTable,
         grammarPtr,
         preservedTokenIds,
         effectiveStopSequences,
+        _promptLookupDrafter(model.pointer, ctx, params),
       );
 
       llama_sampler_free(sampler);
     } finally {
+      if (preparedMedia != null) _releaseMediaBitmaps(preparedMedia);
       malloc.free(tokensPtr);
-      malloc.free(pieceBuf);
       if (grammarPtr != nullptr) malloc.free(grammarPtr);
       if (rootPtr != nullptr) malloc.free(rootPtr);
       lazyGrammarConfig?.dispose();
+      if (useMediaCache) _unpinMultimodalContext(mmHandle!);
+      model.release();
     }
   }
 
@@ -1755,6 +2201,7 @@ class LlamaCppService {
     if (clearMemory) {
       _clearContextMemory(ctx.pointer);
       ctx.cachedPromptTokens = null;
+      ctx.cachedMultimodalChunks = null;
     }
 
     _contexts[contextHandle] = ctx;
@@ -1802,6 +2249,7 @@ class LlamaCppService {
         modelParams,
       );
     } else {
+      ctx.cachedMultimodalChunks = null;
       return _ingestTextPrompt(
         batch,
         vocab,
@@ -1929,90 +2377,521 @@ class LlamaCppService {
       _mtmdInputChunksFree(chunks);
     }
     ctx.cachedPromptTokens = null;
+    ctx.cachedMultimodalChunks = null;
     return initialTokens;
   }
 
-  String _normalizeMtmdPromptMarkers(String prompt, int mediaPartCount) {
-    final markerPtr = _mtmdDefaultMarker();
-    final marker = markerPtr == nullptr
-        ? '<__media__>'
-        : markerPtr.cast<Utf8>().toDartString();
+  /// Whether the chunk-level multimodal cache can be used in this runtime.
+  ///
+  /// The cached path calls mtmd chunk APIs directly, so it is only enabled
+  /// when mtmd symbols resolve from the primary native asset.
+  bool _mtmdMediaCacheAvailable() {
+    _mtmdDefaultMarker();
+    return !_mtmdPrimarySymbolsUnavailable;
+  }
 
-    var normalized = prompt;
-    const directPlaceholders = [
-      '<image>',
-      '[IMG]',
-      '<|image|>',
-      '<img>',
-      '<|img|>',
-    ];
+  /// Resolves a bitmap for every media part, decoding cache misses in
+  /// parallel on helper isolates.
+  ///
+  /// Returned bitmaps stay owned by the media cache but are pinned, so other
+  /// requests cannot evict them meanwhile; callers must release them with
+  /// [_releaseMediaBitmaps] and must not free them.
+  Future<List<_PreparedMediaBitmap>> _prepareMediaBitmaps(
+    int mmHandle,
+    Pointer<mtmd_context> mmCtx,
+    List<LlamaContentPart> mediaParts,
+  ) async {
+    final mediaCache = _mtmdMediaCaches.putIfAbsent(
+      mmHandle,
+      () => _MultimodalMediaCache(_mtmdBitmapFree),
+    );
+    final keys = mediaParts.map(_mediaCacheKey).toList(growable: false);
 
-    for (final placeholder in directPlaceholders) {
-      normalized = normalized.replaceAll(placeholder, marker);
+    final results = await Future.wait([
+      for (var i = 0; i < mediaParts.length; i++)
+        _leaseMediaBitmap(mediaCache, mmCtx, keys[i], mediaParts[i], i).then(
+          (lease) => (lease, null, null),
+          onError: (Object e, StackTrace s) => (null, e, s),
+        ),
+    ]);
+
+    final prepared = <_PreparedMediaBitmap>[];
+    for (var i = 0; i < results.length; i++) {
+      final lease = results[i].$1;
+      if (lease != null) prepared.add(_PreparedMediaBitmap(keys[i]!, lease));
+    }
+    for (final (lease, error, stackTrace) in results) {
+      if (lease == null) {
+        _releaseMediaBitmaps(prepared);
+        Error.throwWithStackTrace(error!, stackTrace!);
+      }
     }
+    return prepared;
+  }
 
-    // Some VLM templates index image placeholders (e.g. <|image_1|>).
-    normalized = normalized.replaceAll(RegExp(r'<\|image_\d+\|>'), marker);
+  void _releaseMediaBitmaps(List<_PreparedMediaBitmap> media) {
+    for (final item in media) {
+      item.lease.release();
+    }
+  }
 
-    if (mediaPartCount <= 0) {
-      return normalized;
+  /// Pins the cached bitmap for [key], decoding it first on a miss.
+  ///
+  /// Concurrent misses on the same key share one decode.
+  Future<CacheLease<Pointer<mtmd_bitmap>>> _leaseMediaBitmap(
+    _MultimodalMediaCache mediaCache,
+    Pointer<mtmd_context> mmCtx,
+    String? key,
+    LlamaContentPart part,
+    int index,
+  ) async {
+    if (key == null) {
+      throw Exception("Failed to load media part $index: file not readable");
     }
+    while (true) {
+      final cached = mediaCache.bitmaps.acquire(key);
+      if (cached != null) return cached;
 
-    final markerCount = _countOccurrences(normalized, marker);
-    if (markerCount < mediaPartCount) {
-      final missing = mediaPartCount - markerCount;
-      final markerBlock = List.filled(missing, marker).join(' ');
+      final pending = mediaCache.pendingBitmaps[key];
+      if (pending != null) {
+        // The other request caches the bitmap; it is usually still there.
+        await pending;
+        continue;
+      }
 
-      if (normalized.contains('User:')) {
-        normalized = normalized.replaceFirst('User:', 'User: $markerBlock ');
-      } else if (normalized.contains('user:')) {
-        normalized = normalized.replaceFirst('user:', 'user: $markerBlock ');
-      } else {
-        normalized = '$markerBlock\n$normalized';
+      final decoded = _decodeMediaBitmapIntoCache(
+        mediaCache,
+        mmCtx,
+        key,
+        part,
+        index,
+      );
+      final done = decoded.then<void>((_) {})..ignore();
+      mediaCache.pendingBitmaps[key] = done;
+      try {
+        return await decoded;
+      } finally {
+        mediaCache.pendingBitmaps.remove(key);
       }
     }
-
-    return normalized;
   }
 
-  int _countOccurrences(String text, String pattern) {
-    if (pattern.isEmpty) {
-      return 0;
+  Future<CacheLease<Pointer<mtmd_bitmap>>> _decodeMediaBitmapIntoCache(
+    _MultimodalMediaCache mediaCache,
+    Pointer<mtmd_context> mmCtx,
+    String key,
+    LlamaContentPart part,
+    int index,
+  ) async {
+    final int address;
+    try {
+      address = await _decodeMediaBitmap(mmCtx, part);
+    } catch (e) {
+      throw Exception("Failed to load media part $index: $e");
+    }
+    if (address == nullptr.address) {
+      throw Exception("Failed to decode media part $index");
     }
 
-    int count = 0;
-    int start = 0;
-    while (true) {
-      final index = text.indexOf(pattern, start);
-      if (index == -1) {
-        break;
-      }
-      count++;
-      start = index + pattern.length;
+    final bitmap = Pointer<mtmd_bitmap>.fromAddress(address);
+    final idPtr = key.toNativeUtf8();
+    try {
+      mtmd_bitmap_set_id(bitmap, idPtr.cast());
+    } finally {
+      malloc.free(idPtr);
     }
-    return count;
+    // Pin in the same synchronous step as the insert so no other request's
+    // trim can evict it before this one uses it.
+    mediaCache.bitmaps.put(key, bitmap, mtmd_bitmap_get_n_bytes(bitmap));
+    return mediaCache.bitmaps.acquire(key)!;
   }
 
-  bool _promptStartsWithBosToken(Pointer<llama_vocab> vocab, String prompt) {
-    final bos = llama_vocab_bos(vocab);
-    if (bos < 0) {
-      return false;
+  String? _mediaCacheKey(LlamaContentPart part) {
+    final kind = part is LlamaAudioContent ? 'audio' : 'image';
+    String? filePath;
+    Uint8List? bytes;
+    if (part is LlamaImageContent) {
+      filePath = part.path;
+      bytes = part.bytes;
+    } else if (part is LlamaAudioContent) {
+      filePath = part.path;
+      bytes = part.bytes;
+      if (filePath == null && bytes == null && part.samples != null) {
+        return mediaSamplesCacheKey(part.samples!);
+      }
     }
 
-    final bosPtr = llama_token_get_text(vocab, bos);
-    if (bosPtr == nullptr) {
-      return false;
+    if (filePath != null) {
+      try {
+        final stat = File(filePath).statSync();
+        if (stat.type == FileSystemEntityType.notFound) {
+          return null;
+        }
+        return mediaFileCacheKey(
+          kind,
+          filePath,
+          stat.size,
+          stat.modified.microsecondsSinceEpoch,
+        );
+      } catch (_) {
+        return null;
+      }
+    }
+    if (bytes != null) {
+      return mediaBytesCacheKey(kind, bytes);
     }
+    return null;
+  }
 
-    final bosToken = bosPtr.cast<Utf8>().toDartString();
-    if (bosToken.isEmpty) {
-      return false;
+  Future<int> _decodeMediaBitmap(
+    Pointer<mtmd_context> mmCtx,
+    LlamaContentPart part,
+  ) {
+    if (part is LlamaAudioContent &&
+        part.path == null &&
+        part.bytes == null &&
+        part.samples != null) {
+      // Raw PCM only needs a copy; no point paying for an isolate hop.
+      final samples = part.samples!;
+      final dataPtr = malloc<Float>(samples.length);
+      try {
+        dataPtr.asTypedList(samples.length).setAll(0, samples);
+        return Future<int>.value(
+          mtmd_bitmap_init_from_audio(samples.length, dataPtr).address,
+        );
+      } finally {
+        malloc.free(dataPtr);
+      }
     }
 
-    return prompt.trimLeft().startsWith(bosToken);
+    final filePath = part is LlamaImageContent
+        ? part.path
+        : (part as LlamaAudioContent).path;
+    final bytes = part is LlamaImageContent
+        ? part.bytes
+        : (part as LlamaAudioContent).bytes;
+    return _decodeMediaBitmapOffWorker(mmCtx.address, filePath, bytes);
   }
 
-  int _ingestTextPrompt(
+  static Future<int> _decodeMediaBitmapOffWorker(
+    int mmCtxAddress,
+    String? filePath,
+    Uint8List? bytes,
+  ) {
+    int decode() => filePath != null
+        ? _mtmdBitmapAddressFromFile(mmCtxAddress, filePath)
+        : _mtmdBitmapAddressFromBuffer(mmCtxAddress, bytes!);
+
+    return runOffWorker(decode);
+  }
+
+  int _ingestCachedMultimodalPrompt(
+    Pointer<mtmd_context> mmCtx,
+    _MultimodalMediaCache mediaCache,
+    _LlamaContextWrapper ctx,
+    llama_batch batch,
+    Pointer<llama_model> model,
+    Pointer<llama_vocab> vocab,
+    String prompt,
+    List<_PreparedMediaBitmap> media,
+    llama_context_params modelParams, {
+    required bool allowPromptReuse,
+  }) {
+    final bitmaps = malloc<Pointer<mtmd_bitmap>>(media.length);
+    final chunks = mtmd_input_chunks_init();
+    final inputText = malloc<mtmd_input_text>();
+    final normalizedPrompt = _normalizeMtmdPromptMarkers(prompt, media.length);
+    final promptPtr = normalizedPrompt.toNativeUtf8();
+    final newPast = malloc<llama_pos>();
+
+    try {
+      for (var i = 0; i < media.length; i++) {
+        bitmaps[i] = media[i].bitmap;
+      }
+
+      inputText.ref.text = promptPtr.cast();
+      final bos = llama_vocab_bos(vocab);
+      final eos = llama_vocab_eos(vocab);
+      inputText.ref.add_special =
+          (bos != eos && bos != -1) &&
+          !_promptStartsWithBosToken(vocab, normalizedPrompt);
+      inputText.ref.parse_special = true;
+
+      final res = mtmd_tokenize(
+        mmCtx,
+        chunks,
+        inputText,
+        bitmaps.cast(),
+        media.length,
+      );
+      if (res != 0) {
+        throw Exception("mtmd_tokenize failed: $res");
+      }
+
+      final chunkCount = mtmd_input_chunks_size(chunks);
+      final signatures = <MultimodalChunkSignature>[];
+      final mediaOrdinals = <String, int>{};
+      for (var i = 0; i < chunkCount; i++) {
+        signatures.add(
+          _mtmdChunkSignature(mtmd_input_chunks_get(chunks, i), mediaOrdinals),
+        );
+      }
+
+      var match = allowPromptReuse
+          ? matchMultimodalPrefix(ctx.cachedMultimodalChunks, signatures)
+          : MultimodalPrefixMatch.none;
+      if (match.reusedPositions > 0) {
+        final memory = llama_get_memory(ctx.pointer);
+        if (memory == nullptr ||
+            !llama_memory_seq_rm(memory, 0, match.reusedPositions, -1)) {
+          match = MultimodalPrefixMatch.none;
+        }
+      }
+      if (match.reusedPositions == 0) {
+        _clearContextMemory(ctx.pointer);
+      }
+      ctx.cachedPromptTokens = null;
+      ctx.cachedMultimodalChunks = null;
+
+      var nPast = match.reusedPositions;
+      for (var i = match.chunkIndex; i < chunkCount; i++) {
+        final signature = signatures[i];
+        if (signature.isText) {
+          nPast = _decodeTextChunkTokens(
+            batch,
+            ctx,
+            signature.textTokens!,
+            startTokenIndex: i == match.chunkIndex ? match.tokenOffset : 0,
+            startPos: nPast,
+            logitsLast: i == chunkCount - 1,
+          );
+        } else {
+          nPast = _decodeMediaChunk(
+            mmCtx,
+            mediaCache,
+            ctx,
+            model,
+            mtmd_input_chunks_get(chunks, i),
+            signature,
+            nPast,
+            modelParams.n_batch,
+            newPast,
+          );
+        }
+      }
+
+      ctx.cachedMultimodalChunks = signatures;
+      return nPast;
+    } finally {
+      malloc.free(newPast);
+      malloc.free(promptPtr);
+      malloc.free(inputText);
+      malloc.free(bitmaps);
+      mtmd_input_chunks_free(chunks);
+      mediaCache.trim();
+    }
+  }
+
+  MultimodalChunkSignature _mtmdChunkSignature(
+    Pointer<mtmd_input_chunk> chunk,
+    Map<String, int> mediaOrdinals,
+  ) {
+    if (mtmd_input_chunk_get_type(chunk) ==
+        mtmd_input_chunk_type.MTMD_INPUT_CHUNK_TYPE_TEXT) {
+      final nTokens = malloc<Size>();
+      try {
+        final tokens = mtmd_input_chunk_get_tokens_text(chunk, nTokens);
+        return MultimodalChunkSignature.text(
+          tokens == nullptr ? const <int>[] : tokens.asTypedList(nTokens.value),
+        );
+      } finally {
+        malloc.free(nTokens);
+      }
+    }
+
+    final idPtr = mtmd_input_chunk_get_id(chunk);
+    final id = idPtr == nullptr ? '' : idPtr.cast<Utf8>().toDartString();
+    final nPos = mtmd_input_chunk_get_n_pos(chunk);
+    if (id.isEmpty) {
+      // Never matches a previous prompt and is never served from cache.
+      return MultimodalChunkSignature.media(
+        '${_MultimodalMediaCache.anonymousPrefix}${_anonymousMediaSerial++}',
+        nPos,
+      );
+    }
+    // One bitmap may expand to several media chunks; keep them distinct.
+    final ordinal = mediaOrdinals.update(
+      id,
+      (value) => value + 1,
+      ifAbsent: () => 0,
+    );
+    return MultimodalChunkSignature.media('$id@$ordinal', nPos);
+  }
+
+  int _decodeTextChunkTokens(
+    llama_batch batch,
+    _LlamaContextWrapper ctx,
+    List<int> tokens, {
+    required int startTokenIndex,
+    required int startPos,
+    required bool logitsLast,
+  }) {
+    final tokenCount = tokens.length - startTokenIndex;
+    if (tokenCount <= 0) {
+      return startPos;
+    }
+
+    batch.n_tokens = tokenCount;
+    for (int i = 0; i < tokenCount; i++) {
+      batch.token[i] = tokens[startTokenIndex + i];
+      batch.pos[i] = startPos + i;
+      batch.n_seq_id[i] = 1;
+      batch.seq_id[i][0] = 0;
+      batch.logits[i] = (logitsLast && i == tokenCount - 1) ? 1 : 0;
+    }
+
+    if (llama_decode(ctx.pointer, batch) != 0) {
+      throw Exception("Initial decode failed");
+    }
+    return startPos + tokenCount;
+  }
+
+  int _decodeMediaChunk(
+    Pointer<mtmd_context> mmCtx,
+    _MultimodalMediaCache mediaCache,
+    _LlamaContextWrapper ctx,
+    Pointer<llama_model> model,
+    Pointer<mtmd_input_chunk> chunk,
+    MultimodalChunkSignature signature,
+    int nPast,
+    int nBatch,
+    Pointer<llama_pos> newPast,
+  ) {
+    final key = signature.mediaId!;
+    final cacheable = !key.startsWith(_MultimodalMediaCache.anonymousPrefix);
+    var embedding = cacheable ? mediaCache.embeddings.get(key) : null;
+    var ownsEmbedding = false;
+
+    if (embedding == null) {
+      final encodeResult = mtmd_encode_chunk(mmCtx, chunk);
+      if (encodeResult != 0) {
+        throw Exception("mtmd_encode_chunk failed: $encodeResult");
+      }
+      final length =
+          mtmd_input_chunk_get_n_tokens(chunk) * llama_model_n_embd_inp(model);
+      final copy = malloc<Float>(length);
+      copy
+          .asTypedList(length)
+          .setAll(0, mtmd_get_output_embd(mmCtx).asTypedList(length));
+      embedding = _CachedMediaEmbedding(copy);
+      if (cacheable) {
+        mediaCache.embeddings.put(key, embedding, length * sizeOf<Float>());
+      } else {
+        ownsEmbedding = true;
+      }
+    }
+
+    try {
+      final decodeResult = mtmd_helper_decode_image_chunk(
+        mmCtx,
+        ctx.pointer,
+        chunk,
+        embedding.data,
+        nPast,
+        0,
+        nBatch,
+        newPast,
+      );
+      if (decodeResult != 0) {
+        throw Exception("Failed to decode media chunk (code: $decodeResult)");
+      }
+      return newPast.value;
+    } finally {
+      if (ownsEmbedding) {
+        embedding.dispose();
+      }
+    }
+  }
+
+  String _normalizeMtmdPromptMarkers(String prompt, int mediaPartCount) {
+    final markerPtr = _mtmdDefaultMarker();
+    final marker = markerPtr == nullptr
+        ? '<__media__>'
+        : markerPtr.cast<Utf8>().toDartString();
+
+    var normalized = prompt;
+    const directPlaceholders = [
+      '<image>',
+      '[IMG]',
+      '<|image|>',
+      '<img>',
+      '<|img|>',
+    ];
+
+    for (final placeholder in directPlaceholders) {
+      normalized = normalized.replaceAll(placeholder, marker);
+    }
+
+    // Some VLM templates index image placeholders (e.g. <|image_1|>).
+    normalized = normalized.replaceAll(RegExp(r'<\|image_\d+\|>'), marker);
+
+    if (mediaPartCount <= 0) {
+      return normalized;
+    }
+
+    final markerCount = _countOccurrences(normalized, marker);
+    if (markerCount < mediaPartCount) {
+      final missing = mediaPartCount - markerCount;
+      final markerBlock = List.filled(missing, marker).join(' ');
+
+      if (normalized.contains('User:')) {
+        normalized = normalized.replaceFirst('User:', 'User: $markerBlock ');
+      } else if (normalized.contains('user:')) {
+        normalized = normalized.replaceFirst('user:', 'user: $markerBlock ');
+      } else {
+        normalized = '$markerBlock\n$normalized';
+      }
+    }
+
+    return normalized;
+  }
+
+  int _countOccurrences(String text, String pattern) {
+    if (pattern.isEmpty) {
+      return 0;
+    }
+
+    int count = 0;
+    int start = 0;
+    while (true) {
+      final index = text.indexOf(pattern, start);
+      if (index == -1) {
+        break;
+      }
+      count++;
+      start = index + pattern.length;
+    }
+    return count;
+  }
+
+  bool _promptStartsWithBosToken(Pointer<llama_vocab> vocab, String prompt) {
+    return startsWithBosText(prompt, _bosTokenText(vocab));
+  }
+
+  String? _bosTokenText(Pointer<llama_vocab> vocab) {
+    final bos = llama_vocab_bos(vocab);
+    if (bos < 0) {
+      return null;
+    }
+
+    final bosPtr = llama_token_get_text(vocab, bos);
+    if (bosPtr == nullptr) {
+      return null;
+    }
+    return bosPtr.cast<Utf8>().toDartString();
+  }
+
+  int _ingestTextPrompt(
     llama_batch batch,
     Pointer<llama_vocab> vocab,
     String prompt,
@@ -2224,7 +3103,38 @@ class LlamaCppService {
     return sampler;
   }
 
+  /// Returns a drafter seeded with the ingested prompt when [params] enable
+  /// prompt-lookup decoding and the context can roll back rejected drafts.
+  PromptLookupDrafter? _promptLookupDrafter(
+    Pointer<llama_model> model,
+    _LlamaContextWrapper ctx,
+    GenerationParams params,
+  ) {
+    if (params.promptLookupDraftTokens <= 0) return null;
+    // Recurrent state cannot drop trailing positions, so drafts would stick.
+    if (llama_model_is_recurrent(model) || llama_model_is_hybrid(model)) {
+      return null;
+    }
+    if (llama_get_memory(ctx.pointer) == nullptr) return null;
+    final ngramSize = params.promptLookupNgramSize < 1
+        ? 1
+        : params.promptLookupNgramSize;
+    return PromptLookupDrafter(
+      maxNgramSize: ngramSize,
+      // Multimodal prompts leave no token copy; draft from the output alone.
+      promptTokens: ctx.cachedPromptTokens ?? const <int>[],
+    );
+  }
+
   /// Helper: Runs the main inference loop and yields tokens.
+  ///
+  /// With a [drafter], each decode also carries the tokens the drafter
+  /// proposes after the sampled one. Later iterations sample from those
+  /// positions' logits in order; while the sampled token equals the draft it
+  /// is already in the KV cache and needs no decode, and the first mismatch
+  /// drops the remaining draft positions with `llama_memory_seq_rm`. Every
+  /// token is still sampled by the same sampler from the logits normal
+  /// decoding would produce, so the output does not change.
   Stream<List<int>> _runInferenceLoop(
     _LlamaContextWrapper ctx,
     llama_batch batch,
@@ -2234,51 +3144,107 @@ class LlamaCppService {
     int startPos,
     int nCtx,
     int cancelTokenAddress,
-    Pointer<Uint8> pieceBuf,
+    VocabPieceTable pieceTable,
     Pointer<Utf8> grammarPtr,
     Set<int> preservedTokenIds,
     List<String> stopSequences,
+    PromptLookupDrafter? drafter,
   ) async* {
     final cancelToken = Pointer<Int8>.fromAddress(cancelTokenAddress);
     int currentPos = startPos;
-    final accumulatedBytes = <int>[];
+    final assembler = Utf8Assembler();
+    var recentText = '';
+    final recentLimit = stopSequences.fold<int>(
+      64,
+      (limit, s) => s.length > limit ? s.length : limit,
+    );
+    final memory = drafter == null ? nullptr : llama_get_memory(ctx.pointer);
+    final lookupStats = drafter == null ? null : ctx.promptLookup;
+    var drafts = const <int>[];
+    var draftCursor = 0;
+    var logitIndex = -1;
 
     for (int i = 0; i < params.maxTokens; i++) {
       if (cancelToken.value == 1) break;
       if (currentPos >= nCtx) break;
 
-      final selectedToken = llama_sampler_sample(sampler, ctx.pointer, -1);
+      final selectedToken = llama_sampler_sample(
+        sampler,
+        ctx.pointer,
+        logitIndex,
+      );
       if (llama_vocab_is_eog(vocab, selectedToken)) break;
+      lookupStats?.generatedTokens++;
 
-      final n = llama_token_to_piece(
-        vocab,
+      final bytes = pieceTable.pieceBytes(
         selectedToken,
-        pieceBuf.cast(),
-        256,
-        0,
-        preservedTokenIds.contains(selectedToken),
+        special: preservedTokenIds.contains(selectedToken),
       );
 
-      if (n > 0) {
-        final bytes = pieceBuf.asTypedList(n).toList();
-        yield bytes;
+      if (bytes.isNotEmpty) {
+        // Copy out of the shared table so isolate messages stay small.
+        yield Uint8List.fromList(bytes);
 
         if (stopSequences.isNotEmpty) {
-          accumulatedBytes.addAll(bytes);
-          if (accumulatedBytes.length > 64) {
-            accumulatedBytes.removeRange(0, accumulatedBytes.length - 64);
+          recentText += assembler.add(bytes);
+          if (recentText.length > recentLimit) {
+            recentText = recentText.substring(recentText.length - recentLimit);
           }
-          final text = utf8.decode(accumulatedBytes, allowMalformed: true);
-          if (stopSequences.any((s) => text.endsWith(s))) break;
+          if (stopSequences.any((s) => recentText.endsWith(s))) break;
         }
       }
 
-      batch.n_tokens = 1;
+      if (drafter != null) {
+        drafter.add(selectedToken);
+        if (draftCursor < drafts.length) {
+          if (selectedToken == drafts[draftCursor]) {
+            // Already decoded as part of the draft batch at batch index
+            // draftCursor + 1; its logits give the next token.
+            draftCursor++;
+            logitIndex = draftCursor;
+            currentPos++;
+            lookupStats!.acceptedTokens++;
+            continue;
+          }
+          if (!llama_memory_seq_rm(memory, 0, currentPos, -1)) {
+            throw Exception(
+              "Failed to drop rejected draft tokens from the KV cache "
+              "(pos: $currentPos)",
+            );
+          }
+        }
+        final room = nCtx - currentPos - 1;
+        final budget = params.maxTokens - i - 1;
+        var limit = params.promptLookupDraftTokens;
+        if (room < limit) limit = room;
+        if (budget < limit) limit = budget;
+        drafts = drafter.draft(limit);
+        draftCursor = 0;
+      }
+
+      batch.n_tokens = 1 + drafts.length;
       batch.token[0] = selectedToken;
-      batch.pos[0] = currentPos++;
+      batch.pos[0] = currentPos;
       batch.n_seq_id[0] = 1;
       batch.seq_id[0][0] = 0;
       batch.logits[0] = 1;
+      for (var d = 0; d < drafts.length; d++) {
+        batch.token[d + 1] = drafts[d];
+        batch.pos[d + 1] = currentPos + d + 1;
+        batch.n_seq_id[d + 1] = 1;
+        batch.seq_id[d + 1][0] = 0;
+        batch.logits[d + 1] = 1;
+      }
+      currentPos++;
+      logitIndex = drafts.isEmpty ? -1 : 0;
+
+      if (lookupStats != null) {
+        lookupStats.decodeCalls++;
+        if (drafts.isNotEmpty) {
+          lookupStats.draftBatches++;
+          lookupStats.draftedTokens += drafts.length;
+        }
+      }
 
       if (llama_decode(ctx.pointer, batch) != 0) break;
     }
@@ -2439,71 +3405,250 @@ class LlamaCppService {
     final model = _models[modelHandle];
     if (model == null) return [];
     final vocab = llama_model_get_vocab(model.pointer);
-    final textPtr = text.toNativeUtf8();
-    final shouldAddSpecial =
-        addSpecial && !_promptStartsWithBosToken(vocab, text);
-    final n = -llama_tokenize(
-      vocab,
-      textPtr.cast(),
-      textPtr.length,
-      nullptr,
-      0,
-      shouldAddSpecial,
-      true,
+    final batch = tokenizeTexts(
+      vocab.address,
+      [text],
+      addSpecial: addSpecial,
+      bosText: _bosTokenText(vocab),
     );
-    final tokensPtr = malloc<Int32>(n);
-    final actual = llama_tokenize(
-      vocab,
-      textPtr.cast(),
-      textPtr.length,
-      tokensPtr,
-      n,
-      shouldAddSpecial,
-      true,
+    // Callers may append to the result, so keep returning a growable list.
+    return List<int>.of(batch.tokens);
+  }
+
+  /// Tokenizes every text in [texts] with one request.
+  ///
+  /// Large batches are split across up to [threads] helper isolates (all
+  /// logical CPUs by default) that share the model's read-only vocabulary,
+  /// so the worker stays free for inference meanwhile.
+  Future<TokenBatch> tokenizeBatch(
+    int modelHandle,
+    List<String> texts,
+    bool addSpecial, {
+    int? threads,
+  }) {
+    return _withVocab(
+      modelHandle,
+      (vocabAddress, bosText) => tokenizeTextsInParallel(
+        vocabAddress,
+        texts,
+        addSpecial: addSpecial,
+        threads: threads ?? Platform.numberOfProcessors,
+        bosText: bosText,
+      ),
+    );
+  }
+
+  /// Counts the tokens of every text in [texts] like [tokenizeBatch],
+  /// without materializing token IDs.
+  Future<Int32List> countTokensBatch(
+    int modelHandle,
+    List<String> texts,
+    bool addSpecial, {
+    int? threads,
+  }) {
+    return _withVocab(
+      modelHandle,
+      (vocabAddress, bosText) => countTokensInParallel(
+        vocabAddress,
+        texts,
+        addSpecial: addSpecial,
+        threads: threads ?? Platform.numberOfProcessors,
+        bosText: bosText,
+      ),
+    );
+  }
+
+  /// Runs [work] against the vocabulary of [modelHandle], keeping the model
+  /// alive until it completes even if it is freed meanwhile.
+  Future<T> _withVocab<T>(
+    int modelHandle,
+    Future<T> Function(int vocabAddress, String? bosText) work,
+  ) async {
+    final model = _models[modelHandle];
+    if (model == null) {
+      throw Exception("Invalid model handle");
+    }
+    final vocab = llama_model_get_vocab(model.pointer);
+    model.retain();
+    try {
+      return await work(vocab.address, _bosTokenText(vocab));
+    } finally {
+      model.release();
+    }
+  }
+
+  /// Quantizes the model at [inputPath] into [outputPath].
+  ///
+  /// The native conversion runs on a helper isolate so the worker keeps
+  /// serving other requests; setting the flag at [cancelTokenAddress]
+  /// abandons the job.
+  Future<void> quantizeModel(
+    String inputPath,
+    String outputPath,
+    QuantizationParams params,
+    int cancelTokenAddress, {
+    void Function(double progress)? onProgress,
+  }) {
+    final cancelToken = Pointer<Int8>.fromAddress(cancelTokenAddress);
+    return quantizeGgufFile(
+      inputPath,
+      outputPath,
+      params,
+      isCancelled: () => cancelToken.value == 1,
+      onProgress: onProgress,
     );
-    final result = List.generate(actual, (i) => tokensPtr[i]);
-    malloc.free(textPtr);
-    malloc.free(tokensPtr);
-    return result;
   }
 
   /// Detokenizes the given [tokens].
   String detokenize(int modelHandle, List<int> tokens, bool special) {
     final model = _models[modelHandle];
     if (model == null) return "";
-    final vocab = llama_model_get_vocab(model.pointer);
-    final buffer = malloc<Int8>(256);
-    final bytes = <int>[];
-    for (final t in tokens) {
-      final n = llama_token_to_piece(vocab, t, buffer.cast(), 256, 0, special);
-      if (n > 0) bytes.addAll(buffer.asTypedList(n));
+    return _pieceTable(model).detokenize(tokens, special: special);
+  }
+
+  /// Returns the vocabulary piece table of [modelHandle], building it on
+  /// first use.
+  VocabPieceTable getVocabPieceTable(int modelHandle) {
+    final model = _models[modelHandle];
+    if (model == null) {
+      throw Exception("Invalid model handle");
     }
-    malloc.free(buffer);
-    return utf8.decode(bytes, allowMalformed: true);
+    return _pieceTable(model);
   }
 
+  VocabPieceTable _pieceTable(_LlamaModelWrapper model) {
+    return model.pieceTable ??= _buildPieceTable(
+      llama_model_get_vocab(model.pointer),
+    );
+  }
+
+  /// Exports every token piece with one pass over the vocabulary.
+  ///
+  /// Pieces are rendered with special tokens enabled; a second render
+  /// without them marks control and unknown tokens that llama.cpp hides.
+  VocabPieceTable _buildPieceTable(Pointer<llama_vocab> vocab) {
+    final nVocab = llama_vocab_n_tokens(vocab);
+    final offsets = Uint32List(nVocab + 1);
+    final flags = Uint8List(nVocab);
+    final bytes = BytesBuilder();
+    var capacity = 256;
+    var buffer = malloc<Uint8>(capacity);
+    try {
+      for (var token = 0; token < nVocab; token++) {
+        var n = llama_token_to_piece(
+          vocab,
+          token,
+          buffer.cast(),
+          capacity,
+          0,
+          true,
+        );
+        if (n < 0) {
+          // A negative result is the size the piece needs.
+          malloc.free(buffer);
+          capacity = -n;
+          buffer = malloc<Uint8>(capacity);
+          n = llama_token_to_piece(
+            vocab,
+            token,
+            buffer.cast(),
+            capacity,
+            0,
+            true,
+          );
+        }
+        if (n > 0) {
+          bytes.add(buffer.asTypedList(n));
+          final plain = llama_token_to_piece(
+            vocab,
+            token,
+            buffer.cast(),
+            capacity,
+            0,
+            false,
+          );
+          if (plain == 0) {
+            flags[token] = VocabPieceTable.hiddenUnlessSpecial;
+          }
+        }
+        offsets[token + 1] = bytes.length;
+      }
+    } finally {
+      malloc.free(buffer);
+    }
+    return VocabPieceTable(
+      bytes: bytes.takeBytes(),
+      offsets: offsets,
+      flags: flags,
+    );
+  }
+
+  /// Returns the GGUF header parsed when [modelHandle] was loaded, or null
+  /// when the header could not be inspected.
+  GgufModelInfo? getModelInfo(int modelHandle) =>
+      _models[modelHandle]?.ggufInfo;
+
   /// Returns metadata for the specified [modelHandle].
+  ///
+  /// Served from the GGUF header parsed at load time; falls back to the
+  /// llama.cpp accessors when the header was not retained.
   Map<String, String> getMetadata(int modelHandle) {
     final model = _models[modelHandle];
     if (model == null) return {};
+    final ggufInfo = model.ggufInfo;
+    if (ggufInfo != null) return ggufInfo.toMetadataStrings();
+
     final metadata = <String, String>{};
-    final keyBuf = malloc<Int8>(1024);
-    final valBuf = malloc<Int8>(1024 * 64);
-    final n = llama_model_meta_count(model.pointer);
-    for (int i = 0; i < n; i++) {
-      llama_model_meta_key_by_index(model.pointer, i, keyBuf.cast(), 1024);
-      llama_model_meta_val_str_by_index(
-        model.pointer,
-        i,
-        valBuf.cast(),
-        1024 * 64,
-      );
-      metadata[keyBuf.cast<Utf8>().toDartString()] = valBuf
-          .cast<Utf8>()
-          .toDartString();
+    var keyCapacity = 1024;
+    var valCapacity = 1024 * 64;
+    var keyBuf = malloc<Int8>(keyCapacity);
+    var valBuf = malloc<Int8>(valCapacity);
+    try {
+      final n = llama_model_meta_count(model.pointer);
+      for (int i = 0; i < n; i++) {
+        final keyLength = llama_model_meta_key_by_index(
+          model.pointer,
+          i,
+          keyBuf.cast(),
+          keyCapacity,
+        );
+        if (keyLength >= keyCapacity) {
+          malloc.free(keyBuf);
+          keyCapacity = keyLength + 1;
+          keyBuf = malloc<Int8>(keyCapacity);
+          llama_model_meta_key_by_index(
+            model.pointer,
+            i,
+            keyBuf.cast(),
+            keyCapacity,
+          );
+        }
+        final valLength = llama_model_meta_val_str_by_index(
+          model.pointer,
+          i,
+          valBuf.cast(),
+          valCapacity,
+        );
+        if (valLength >= valCapacity) {
+          // Long values (chat templates) would otherwise be truncated.
+          malloc.free(valBuf);
+          valCapacity = valLength + 1;
+          valBuf = malloc<Int8>(valCapacity);
+          llama_model_meta_val_str_by_index(
+            model.pointer,
+            i,
+            valBuf.cast(),
+            valCapacity,
+          );
+        }
+        metadata[keyBuf.cast<Utf8>().toDartString()] = valBuf
+            .cast<Utf8>()
+            .toDartString();
+      }
+    } finally {
+      malloc.free(keyBuf);
+      malloc.free(valBuf);
     }
-    malloc.free(keyBuf);
-    malloc.free(valBuf);
     return metadata;
   }
 
@@ -2513,53 +3658,201 @@ class LlamaCppService {
     final modelHandle = _contextToModel[contextHandle];
     if (ctx == null || modelHandle == null) return;
 
+    final loraSets = _loraSets[contextHandle];
+    if (loraSets == null) return;
+
+    final next = Map<String, double>.of(loraSets.configured);
+    if (op == 'set') {
+      if (path == null) {
+        throw Exception('LoRA path is required for set operation');
+      }
+      if (scale == null) {
+        throw Exception('LoRA scale is required for set operation');
+      }
+      next[path] = scale;
+    } else if (op == 'remove') {
+      if (path == null) {
+        throw Exception('LoRA path is required for remove operation');
+      }
+      next.remove(path);
+    } else if (op == 'clear') {
+      next.clear();
+    } else {
+      throw Exception('Unknown LoRA operation: $op');
+    }
+
+    _switchAdapterSet(contextHandle, ctx, modelHandle, next);
+    loraSets.configure(next);
+  }
+
+  /// Returns LoRA adapter switching statistics for [contextHandle].
+  LoraSwitchStats getLoraSwitchStats(int contextHandle) {
+    final ctx = _contexts[contextHandle];
+    if (ctx == null) throw Exception("Invalid context handle");
+
+    final switches = ctx.adapterSwitches;
+    return LoraSwitchStats(
+      activeAdapterSet: _loraSets[contextHandle]?.activeKey ?? '',
+      swapCount: switches.count,
+      totalSwapTime: Duration(microseconds: switches.totalMicros),
+      lastSwapTime: Duration(microseconds: switches.lastMicros),
+      prefixRestores: switches.prefixRestores,
+      prefixMisses: switches.prefixMisses,
+      snapshotCount: ctx.adapterPrefixSnapshots?.length ?? 0,
+      snapshotBytes: ctx.adapterPrefixSnapshots?.totalBytes ?? 0,
+      totalSnapshotTime: Duration(microseconds: switches.snapshotMicros),
+      lastSnapshotTime: Duration(microseconds: switches.lastSnapshotMicros),
+    );
+  }
+
+  /// Returns prompt-lookup decoding statistics for [contextHandle].
+  PromptLookupStats getPromptLookupStats(int contextHandle) {
+    final ctx = _contexts[contextHandle];
+    if (ctx == null) throw Exception("Invalid context handle");
+
+    final counters = ctx.promptLookup;
+    return PromptLookupStats(
+      generatedTokens: counters.generatedTokens,
+      decodeCalls: counters.decodeCalls,
+      draftBatches: counters.draftBatches,
+      draftedTokens: counters.draftedTokens,
+      acceptedTokens: counters.acceptedTokens,
+    );
+  }
+
+  /// Switches [contextHandle] to exactly the adapters in [next].
+  ///
+  /// When the context has a snapshot budget, the evaluated prompt prefix of
+  /// the outgoing adapter set is snapshotted so a later request for that set
+  /// resumes from it instead of re-ingesting, and the incoming set's snapshot
+  /// is restored when one is retained.
+  void _switchAdapterSet(
+    int contextHandle,
+    _LlamaContextWrapper ctx,
+    int modelHandle,
+    Map<String, double> next,
+  ) {
     final modelAdapters = _loraAdapters[modelHandle];
-    final activeLoras = _activeLoras[contextHandle];
-    if (modelAdapters == null || activeLoras == null) return;
+    final loraSets = _loraSets[contextHandle];
+    if (modelAdapters == null || loraSets == null) return;
+
+    final currentKey = loraSets.activeKey;
+    final nextKey = LoraAdapterSets.keyOf(next);
+    if (currentKey == nextKey) return;
+
+    final stopwatch = Stopwatch()..start();
+    for (final path in next.keys) {
+      _loadLoraAdapter(modelHandle, modelAdapters, path);
+    }
+
+    final snapshotStopwatch = Stopwatch()..start();
+    _saveAdapterPrefixSnapshot(ctx, currentKey);
+    snapshotStopwatch.stop();
+    _applyActiveLoras(ctx.pointer, modelAdapters, next);
+    loraSets.markApplied(next);
+    snapshotStopwatch.start();
+    final restored = _restoreAdapterPrefixSnapshot(ctx, nextKey);
+    snapshotStopwatch.stop();
+    stopwatch.stop();
+
+    ctx.adapterSwitches.record(
+      stopwatch.elapsedMicroseconds,
+      snapshotMicros: snapshotStopwatch.elapsedMicroseconds,
+      restored: restored,
+    );
+  }
 
-    try {
-      if (op == 'set') {
-        if (path == null) {
-          throw Exception('LoRA path is required for set operation');
-        }
-        if (scale == null) {
-          throw Exception('LoRA scale is required for set operation');
-        }
+  _LlamaLoraWrapper _loadLoraAdapter(
+    int modelHandle,
+    Map<String, _LlamaLoraWrapper> modelAdapters,
+    String path,
+  ) {
+    final existing = modelAdapters[path];
+    if (existing != null) return existing;
 
-        var adapter = modelAdapters[path];
-        if (adapter == null) {
-          final pathPtr = path.toNativeUtf8();
-          final adapterPtr = llama_adapter_lora_init(
-            _models[modelHandle]!.pointer,
-            pathPtr.cast(),
-          );
-          malloc.free(pathPtr);
-          if (adapterPtr == nullptr) {
-            throw Exception("Failed to load LoRA at $path");
-          }
-          adapter = _LlamaLoraWrapper(adapterPtr);
-          modelAdapters[path] = adapter;
-        }
-        activeLoras[path] = scale;
-        _applyActiveLoras(ctx.pointer, modelAdapters, activeLoras);
-        ctx.cachedPromptTokens = null;
-      } else if (op == 'remove') {
-        if (path == null) {
-          throw Exception('LoRA path is required for remove operation');
-        }
-        activeLoras.remove(path);
-        _applyActiveLoras(ctx.pointer, modelAdapters, activeLoras);
-        ctx.cachedPromptTokens = null;
-      } else if (op == 'clear') {
-        activeLoras.clear();
-        _applyActiveLoras(ctx.pointer, modelAdapters, activeLoras);
-        ctx.cachedPromptTokens = null;
-      } else {
-        throw Exception('Unknown LoRA operation: $op');
-      }
-    } catch (e) {
-      rethrow;
+    final pathPtr = path.toNativeUtf8();
+    final adapterPtr = llama_adapter_lora_init(
+      _models[modelHandle]!.pointer,
+      pathPtr.cast(),
+    );
+    malloc.free(pathPtr);
+    if (adapterPtr == nullptr) {
+      throw Exception("Failed to load LoRA at $path");
+    }
+    final adapter = _LlamaLoraWrapper(adapterPtr);
+    modelAdapters[path] = adapter;
+    return adapter;
+  }
+
+  void _saveAdapterPrefixSnapshot(
+    _LlamaContextWrapper ctx,
+    String adapterKey,
+  ) {
+    final snapshots = ctx.adapterPrefixSnapshots;
+    if (snapshots == null) return;
+
+    final promptTokens = ctx.cachedPromptTokens;
+    final multimodalChunks = ctx.cachedMultimodalChunks;
+    final prefixPositions = multimodalChunks != null
+        ? multimodalChunks.fold<int>(0, (sum, chunk) => sum + chunk.nPos)
+        : promptTokens?.length ?? 0;
+    if (prefixPositions <= 0) return;
+
+    // Only the prompt prefix can be reused; drop generated tokens so they
+    // are not copied. The caller clears the sequence right after anyway.
+    final memory = llama_get_memory(ctx.pointer);
+    if (memory == nullptr ||
+        !llama_memory_seq_rm(memory, 0, prefixPositions, -1)) {
+      return;
+    }
+
+    llama_synchronize(ctx.pointer);
+    final size = llama_state_seq_get_size(ctx.pointer, 0);
+    if (size <= 0 || size > snapshots.maxBytes) {
+      return;
+    }
+
+    final data = malloc<Uint8>(size);
+    final written = llama_state_seq_get_data(ctx.pointer, data, size, 0);
+    if (written <= 0) {
+      malloc.free(data);
+      return;
+    }
+
+    snapshots.put(
+      adapterKey,
+      _AdapterPrefixSnapshot(data, written, promptTokens, multimodalChunks),
+      written,
+    );
+    snapshots.trim();
+  }
+
+  bool _restoreAdapterPrefixSnapshot(
+    _LlamaContextWrapper ctx,
+    String adapterKey,
+  ) {
+    // KV entries computed under the previous adapter set are not valid for
+    // the new one.
+    _clearContextMemory(ctx.pointer);
+    ctx.invalidatePromptCache();
+
+    final snapshot = ctx.adapterPrefixSnapshots?.get(adapterKey);
+    if (snapshot == null) return false;
+
+    final read = llama_state_seq_set_data(
+      ctx.pointer,
+      snapshot.data,
+      snapshot.size,
+      0,
+    );
+    if (read == 0) {
+      _clearContextMemory(ctx.pointer);
+      return false;
     }
+
+    ctx.cachedPromptTokens = snapshot.promptTokens;
+    ctx.cachedMultimodalChunks = snapshot.multimodalChunks;
+    return true;
   }
 
   void _applyActiveLoras(
@@ -2697,14 +3990,20 @@ class LlamaCppService {
       c.dispose();
     }
     _contexts.clear();
+    for (final pools in _threadpools.values) {
+      pools.dispose();
+    }
+    _threadpools.clear();
     for (final m in _models.values) {
-      m.dispose();
+      m.release();
     }
     _models.clear();
-    for (final m in _mtmdContexts.values) {
-      _mtmdFree(m);
+    for (final mmHandle in {
+      ..._mtmdMediaCaches.keys,
+      ..._mtmdContexts.keys,
+    }) {
+      _disposeMultimodalContext(mmHandle);
     }
-    _mtmdContexts.clear();
     // llama_backend_free(); // DISABLED: Prevents race conditions with other isolates
   }
 
@@ -2737,13 +4036,48 @@ class LlamaCppService {
 
   /// Frees the multimodal context (projector).
   void freeMultimodalContext(int mmContextHandle) {
-    final mmCtx = _mtmdContexts.remove(mmContextHandle);
-    if (mmCtx != null) {
-      _mtmdFree(mmCtx);
+    if (_disposeMultimodalContext(mmContextHandle)) {
       _modelToMtmd.removeWhere((k, v) => v == mmContextHandle);
+      // KV entries produced by this projector can no longer be matched.
+      for (final ctx in _contexts.values) {
+        ctx.cachedMultimodalChunks = null;
+      }
     }
   }
 
+  /// Unregisters the projector [mmHandle] and its media cache, freeing them
+  /// once no request is decoding media with them. Returns whether the
+  /// projector was registered.
+  bool _disposeMultimodalContext(int mmHandle) {
+    final cache = _mtmdMediaCaches.remove(mmHandle);
+    final mmCtx = _mtmdContexts.remove(mmHandle);
+    void free() {
+      cache?.dispose();
+      if (mmCtx != null) _mtmdFree(mmCtx);
+    }
+
+    if (_mtmdPins.containsKey(mmHandle)) {
+      _deferredMtmdFrees[mmHandle] = free;
+    } else {
+      free();
+    }
+    return mmCtx != null;
+  }
+
+  void _pinMultimodalContext(int mmHandle) {
+    _mtmdPins[mmHandle] = (_mtmdPins[mmHandle] ?? 0) + 1;
+  }
+
+  void _unpinMultimodalContext(int mmHandle) {
+    final pins = _mtmdPins[mmHandle]! - 1;
+    if (pins > 0) {
+      _mtmdPins[mmHandle] = pins;
+      return;
+    }
+    _mtmdPins.remove(mmHandle);
+    _deferredMtmdFrees.remove(mmHandle)?.call();
+  }
+
   Pointer<Char> _mtmdDefaultMarker() {
     if (!_mtmdPrimarySymbolsUnavailable) {
       try {
@@ -3204,6 +4538,29 @@ class _MtmdApi {
 
 // --- Native Wrappers ---
 
+/// `ggml_threadpool_new` / `ggml_threadpool_free` resolved from the CPU
+/// backend registry.
+class _GgmlThreadpoolApi {
+  final _GgmlThreadpoolNewDart create;
+  final _GgmlThreadpoolFreeDart free;
+  const _GgmlThreadpoolApi(this.create, this.free);
+}
+
+class _ContextThreadpools {
+  final _GgmlThreadpoolApi _api;
+  final ggml_threadpool_t decode;
+
+  /// Separate prefill pool, or `nullptr` when prefill shares [decode].
+  final ggml_threadpool_t batch;
+  _ContextThreadpools(this._api, this.decode, this.batch);
+
+  /// Frees the pools. The owning context must already be freed.
+  void dispose() {
+    _api.free(decode);
+    if (batch != nullptr) _api.free(batch);
+  }
+}
+
 class _LlamaLoraWrapper {
   final Pointer<llama_adapter_lora> pointer;
   _LlamaLoraWrapper(this.pointer);
@@ -3214,21 +4571,192 @@ class _LlamaLoraWrapper {
 
 class _LlamaModelWrapper {
   final Pointer<llama_model> pointer;
-  _LlamaModelWrapper(this.pointer);
-  void dispose() {
-    llama_model_free(pointer);
+  final GgufModelInfo? ggufInfo;
+  VocabPieceTable? pieceTable;
+
+  // The service holds one reference; batch tokenizations running on helper
+  // isolates hold one each.
+  int _references = 1;
+
+  _LlamaModelWrapper(this.pointer, [this.ggufInfo]);
+
+  void retain() {
+    _references++;
+  }
+
+  /// Drops a reference and frees the model once none remain.
+  void release() {
+    if (--_references == 0) {
+      llama_model_free(pointer);
+    }
   }
 }
 
 class _LlamaContextWrapper {
+  static const int maxAdapterSnapshots = 8;
+
   final Pointer<llama_context> pointer;
   final _LlamaModelWrapper? _modelKeepAlive;
   List<int>? cachedPromptTokens;
-  _LlamaContextWrapper(this.pointer, this._modelKeepAlive);
+  List<MultimodalChunkSignature>? cachedMultimodalChunks;
+
+  /// Warm prompt prefixes keyed by adapter set, so each tenant sharing this
+  /// context resumes from its own KV state. Null when the context was
+  /// created without a snapshot budget.
+  final ByteBudgetLruCache<_AdapterPrefixSnapshot>? adapterPrefixSnapshots;
+  final _AdapterSwitchCounters adapterSwitches = _AdapterSwitchCounters();
+  final _PromptLookupCounters promptLookup = _PromptLookupCounters();
+
+  _LlamaContextWrapper(
+    this.pointer,
+    this._modelKeepAlive, [
+    int snapshotBudgetBytes = 0,
+  ]) : adapterPrefixSnapshots = snapshotBudgetBytes > 0
+           ? ByteBudgetLruCache<_AdapterPrefixSnapshot>(
+               maxEntries: maxAdapterSnapshots,
+               maxBytes: snapshotBudgetBytes,
+               onEvict: (snapshot) => snapshot.dispose(),
+             )
+           : null;
+  void invalidatePromptCache() {
+    cachedPromptTokens = null;
+    cachedMultimodalChunks = null;
+  }
+
   void dispose() {
     // ignore: unused_local_variable
     final _ = _modelKeepAlive;
-    cachedPromptTokens = null;
+    invalidatePromptCache();
+    adapterPrefixSnapshots?.clear();
     llama_free(pointer);
   }
 }
+
+class _AdapterPrefixSnapshot {
+  final Pointer<Uint8> data;
+  final int size;
+  final List<int>? promptTokens;
+  final List<MultimodalChunkSignature>? multimodalChunks;
+  _AdapterPrefixSnapshot(
+    this.data,
+    this.size,
+    this.promptTokens,
+    this.multimodalChunks,
+  );
+  void dispose() {
+    malloc.free(data);
+  }
+}
+
+class _PromptLookupCounters {
+  int generatedTokens = 0;
+  int decodeCalls = 0;
+  int draftBatches = 0;
+  int draftedTokens = 0;
+  int acceptedTokens = 0;
+}
+
+class _AdapterSwitchCounters {
+  int count = 0;
+  int totalMicros = 0;
+  int lastMicros = 0;
+  int prefixRestores = 0;
+  int prefixMisses = 0;
+  int snapshotMicros = 0;
+  int lastSnapshotMicros = 0;
+
+  void record(
+    int micros, {
+    required int snapshotMicros,
+    required bool restored,
+  }) {
+    count++;
+    totalMicros += micros;
+    lastMicros = micros;
+    this.snapshotMicros += snapshotMicros;
+    lastSnapshotMicros = snapshotMicros;
+    if (restored) {
+      prefixRestores++;
+    } else {
+      prefixMisses++;
+    }
+  }
+}
+
+class _PreparedMediaBitmap {
+  final String key;
+  final CacheLease<Pointer<mtmd_bitmap>> lease;
+  const _PreparedMediaBitmap(this.key, this.lease);
+  Pointer<mtmd_bitmap> get bitmap => lease.value;
+}
+
+class _CachedMediaEmbedding {
+  final Pointer<Float> data;
+  _CachedMediaEmbedding(this.data);
+  void dispose() {
+    malloc.free(data);
+  }
+}
+
+/// Per-projector cache of decoded media bitmaps and projector outputs.
+class _MultimodalMediaCache {
+  static const String anonymousPrefix = 'anonymous#';
+  static const int maxBitmapEntries = 32;
+  static const int maxBitmapBytes = 256 * 1024 * 1024;
+  static const int maxEmbeddingEntries = 64;
+  static const int maxEmbeddingBytes = 512 * 1024 * 1024;
+
+  final ByteBudgetLruCache<Pointer<mtmd_bitmap>> bitmaps;
+  final ByteBudgetLruCache<_CachedMediaEmbedding> embeddings;
+
+  /// Decodes in flight, keyed like [bitmaps].
+  final Map<String, Future<void>> pendingBitmaps = {};
+
+  _MultimodalMediaCache(void Function(Pointer<mtmd_bitmap>) freeBitmap)
+    : bitmaps = ByteBudgetLruCache<Pointer<mtmd_bitmap>>(
+        maxEntries: maxBitmapEntries,
+        maxBytes: maxBitmapBytes,
+        onEvict: freeBitmap,
+      ),
+      embeddings = ByteBudgetLruCache<_CachedMediaEmbedding>(
+        maxEntries: maxEmbeddingEntries,
+        maxBytes: maxEmbeddingBytes,
+        onEvict: (embedding) => embedding.dispose(),
+      );
+
+  void trim() {
+    bitmaps.trim();
+    embeddings.trim();
+  }
+
+  void dispose() {
+    bitmaps.clear();
+    embeddings.clear();
+  }
+}
+
+int _mtmdBitmapAddressFromFile(int mmCtxAddress, String filePath) {
+  final pathPtr = filePath.toNativeUtf8();
+  try {
+    return mtmd_helper_bitmap_init_from_file(
+      Pointer<mtmd_context>.fromAddress(mmCtxAddress),
+      pathPtr.cast(),
+    ).address;
+  } finally {
+    malloc.free(pathPtr);
+  }
+}
+
+int _mtmdBitmapAddressFromBuffer(int mmCtxAddress, Uint8List bytes) {
+  final dataPtr = malloc<Uint8>(bytes.length);
+  try {
+    dataPtr.asTypedList(bytes.length).setAll(0, bytes);
+    return mtmd_helper_bitmap_init_from_buf(
+      Pointer<mtmd_context>.fromAddress(mmCtxAddress),
+      dataPtr.cast(),
+      bytes.length,
+    ).address;
+  } finally {
+    malloc.free(dataPtr);
+  }
+}
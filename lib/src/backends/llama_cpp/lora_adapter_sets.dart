@@ -0,0 +1,44 @@
+import '../../core/models/config/lora_config.dart';
+
+/// LoRA adapter state of one context: the set configured through `setLora`
+/// and the set currently applied, which differ while a request runs with its
+/// own `GenerationParams.loras`.
+class LoraAdapterSets {
+  Map<String, double> _configured = const {};
+  Map<String, double> _active = const {};
+
+  /// Adapter scales configured on the context, keyed by path.
+  Map<String, double> get configured => _configured;
+
+  /// Adapter scales currently applied to the context, keyed by path.
+  Map<String, double> get active => _active;
+
+  /// Canonical key of [active].
+  String get activeKey => keyOf(_active);
+
+  /// Returns the adapter set a request with [requestLoras] must run with:
+  /// exactly [requestLoras], or [configured] when it is null.
+  Map<String, double> targetFor(List<LoraAdapterConfig>? requestLoras) {
+    if (requestLoras == null) return _configured;
+    return {for (final adapter in requestLoras) adapter.path: adapter.scale};
+  }
+
+  /// Records [scales] as the set configured through `setLora`.
+  void configure(Map<String, double> scales) {
+    _configured = Map.unmodifiable(scales);
+  }
+
+  /// Records [scales] as the set now applied to the context.
+  void markApplied(Map<String, double> scales) {
+    _active = Map.unmodifiable(scales);
+  }
+
+  /// Returns the canonical key of [scales], as `LoraAdapterConfig.setKey`.
+  static String keyOf(Map<String, double> scales) {
+    return LoraAdapterConfig.setKey(
+      scales.entries.map(
+        (entry) => LoraAdapterConfig(path: entry.key, scale: entry.value),
+      ),
+    );
+  }
+}
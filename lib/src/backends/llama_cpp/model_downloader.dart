@@ -0,0 +1,613 @@
+import 'dart:async';
+import 'dart:collection';
+import 'dart:convert';
+import 'dart:io';
+import 'dart:typed_data';
+
+import 'package:http/http.dart' as http;
+import 'package:path/path.dart' as path;
+
+import '../../core/download/model_download_progress.dart';
+import '../../core/download/sha256_hasher.dart';
+import 'gguf_file_source.dart';
+
+/// Downloads model files with parallel HTTP range requests.
+///
+/// Chunks are written in place into a preallocated `<destination>.part` file.
+/// A `<destination>.part.json` manifest records finished chunks (and the
+/// SHA-256 state of the verified prefix) so an interrupted download resumes
+/// without refetching or rehashing completed data. Servers without range
+/// support fall back to a single streamed request.
+class ModelDownloader {
+  /// Default number of concurrent range requests.
+  static const int defaultConnections = 4;
+
+  /// Default size of one range request.
+  static const int defaultChunkSize = 32 * 1024 * 1024;
+
+  static const int _hashReadSize = 1024 * 1024;
+  static const int _progressStepBytes = 1024 * 1024;
+
+  /// Maximum number of concurrent range requests.
+  final int connections;
+
+  /// Bytes fetched per range request.
+  final int chunkSize;
+
+  /// Attempts per chunk before the download fails.
+  final int maxAttempts;
+
+  /// Delay before retrying a failed chunk; doubles on each retry.
+  final Duration retryDelay;
+
+  final http.Client Function() _clientFactory;
+
+  /// Creates a downloader.
+  ///
+  /// [clientFactory] creates the HTTP client used for one download and
+  /// exists mainly for testing.
+  ModelDownloader({
+    this.connections = defaultConnections,
+    this.chunkSize = defaultChunkSize,
+    this.maxAttempts = 4,
+    this.retryDelay = const Duration(milliseconds: 500),
+    http.Client Function()? clientFactory,
+  }) : _clientFactory = clientFactory ?? http.Client.new {
+    if (connections < 1) {
+      throw ArgumentError.value(connections, 'connections', 'must be >= 1');
+    }
+    if (chunkSize < 1) {
+      throw ArgumentError.value(chunkSize, 'chunkSize', 'must be >= 1');
+    }
+  }
+
+  /// Downloads [uri] to [destinationPath] and returns the finished file.
+  ///
+  /// When [sha256] is given the data is hashed as contiguous chunks complete
+  /// and the download fails on mismatch; an existing destination file is
+  /// only reused when its digest matches. Without [sha256], an existing GGUF
+  /// file is reused when all of its tensor data is present, and any other
+  /// file when its size matches the remote size. [onProgress] receives
+  /// throttled snapshots. [headers] are sent with every request (for example
+  /// an `Authorization` header for gated repositories).
+  Future<File> download(
+    Uri uri,
+    String destinationPath, {
+    String? sha256,
+    Map<String, String> headers = const {},
+    void Function(ModelDownloadProgress progress)? onProgress,
+  }) async {
+    final target = File(destinationPath);
+    final expectedDigest = sha256?.trim().toLowerCase();
+    final digestFile = File('$destinationPath.sha256');
+
+    if (target.existsSync()) {
+      final reusable = expectedDigest != null
+          ? await _verifyExisting(target, digestFile, expectedDigest)
+          : await _isCompleteExisting(target, uri, headers);
+      if (reusable) {
+        final bytes = target.lengthSync();
+        onProgress?.call(
+          ModelDownloadProgress(
+            receivedBytes: bytes,
+            totalBytes: bytes,
+            resumedBytes: bytes,
+          ),
+        );
+        return target;
+      }
+    }
+
+    target.parent.createSync(recursive: true);
+    final job = _DownloadJob(
+      downloader: this,
+      uri: uri,
+      headers: headers,
+      partFile: File('$destinationPath.part'),
+      manifestFile: File('$destinationPath.part.json'),
+      hashing: expectedDigest != null,
+      onProgress: onProgress,
+    );
+
+    final client = _clientFactory();
+    final String? digest;
+    try {
+      digest = await job.run(client);
+    } finally {
+      client.close();
+    }
+
+    if (expectedDigest != null && digest != expectedDigest) {
+      job.discard();
+      throw Exception(
+        'SHA-256 mismatch for $uri: expected $expectedDigest, got $digest',
+      );
+    }
+
+    if (target.existsSync()) {
+      target.deleteSync();
+    }
+    job.partFile.renameSync(target.path);
+    job.discardManifest();
+    if (digest != null) {
+      digestFile.writeAsStringSync(digest);
+    }
+    return target;
+  }
+
+  Future<bool> _verifyExisting(
+    File target,
+    File digestFile,
+    String expectedDigest,
+  ) async {
+    if (digestFile.existsSync() &&
+        digestFile.readAsStringSync().trim() == expectedDigest) {
+      return true;
+    }
+    final hasher = Sha256Hasher();
+    await for (final data in target.openRead()) {
+      hasher.add(data);
+    }
+    final digest = hasher.close();
+    if (digest != expectedDigest) return false;
+    digestFile.writeAsStringSync(digest);
+    return true;
+  }
+
+  /// Checks an existing [target] that has no digest to verify against.
+  ///
+  /// GGUF files are checked locally so cached models load offline; other
+  /// files are compared with the remote size and kept when it is unknown.
+  Future<bool> _isCompleteExisting(
+    File target,
+    Uri uri,
+    Map<String, String> headers,
+  ) async {
+    try {
+      return inspectGgufFile(target.path).isComplete;
+    } on FormatException {
+      // Not a GGUF file (or an unreadable header); fall through.
+    } on FileSystemException {
+      return false;
+    }
+
+    final remoteSize = await _probeRemoteSize(uri, headers);
+    return remoteSize == null || remoteSize == target.lengthSync();
+  }
+
+  /// Returns the size of [uri] as reported by the server, or `null` when it
+  /// cannot be determined.
+  Future<int?> _probeRemoteSize(Uri uri, Map<String, String> headers) async {
+    final client = _clientFactory();
+    try {
+      final probe = http.Request('GET', uri)
+        ..headers.addAll(headers)
+        ..headers[HttpHeaders.rangeHeader] = 'bytes=0-0';
+      final response = await client.send(probe);
+      // Do not read a full body when the server ignores the range.
+      await response.stream.listen(null).cancel();
+      if (response.statusCode == HttpStatus.partialContent) {
+        return _parseContentRangeTotal(
+          response.headers[HttpHeaders.contentRangeHeader],
+        );
+      }
+      if (response.statusCode == HttpStatus.ok) {
+        return response.contentLength;
+      }
+      return null;
+    } on Exception {
+      return null;
+    } finally {
+      client.close();
+    }
+  }
+}
+
+/// Returns a cache path for the model at [uri] below [cacheDirectory].
+///
+/// The host and path segments are kept so equally named files from
+/// different repositories do not collide; query strings are ignored.
+String modelCachePathForUri(String cacheDirectory, Uri uri) {
+  final segments = [
+    if (uri.host.isNotEmpty) uri.host,
+    ...uri.pathSegments.where((s) => s.isNotEmpty),
+  ].map(_sanitizeSegment).toList();
+  if (segments.isEmpty) {
+    segments.add('model.gguf');
+  }
+  return path.joinAll([cacheDirectory, ...segments]);
+}
+
+String _sanitizeSegment(String segment) {
+  final cleaned = segment.replaceAll(RegExp(r'[^A-Za-z0-9._-]'), '_');
+  return cleaned == '.' || cleaned == '..' ? '_' : cleaned;
+}
+
+class _RemoteChangedException implements Exception {
+  final Uri uri;
+
+  const _RemoteChangedException(this.uri);
+
+  @override
+  String toString() => 'Remote file changed during download: $uri';
+}
+
+class _DownloadJob {
+  final ModelDownloader downloader;
+  final Uri uri;
+  final Map<String, String> headers;
+  final File partFile;
+  final File manifestFile;
+  final bool hashing;
+  final void Function(ModelDownloadProgress progress)? onProgress;
+
+  int? _totalBytes;
+  String? _validator;
+  int _received = 0;
+  int _resumed = 0;
+  int _lastReported = -1;
+
+  late List<bool> _completed;
+  int _hashedChunks = 0;
+  Sha256Hasher? _hasher;
+  Future<void> _bookkeeping = Future<void>.value();
+
+  _DownloadJob({
+    required this.downloader,
+    required this.uri,
+    required this.headers,
+    required this.partFile,
+    required this.manifestFile,
+    required this.hashing,
+    required this.onProgress,
+  });
+
+  int get _chunkSize => downloader.chunkSize;
+
+  /// Runs the download and returns the digest when hashing.
+  Future<String?> run(http.Client client) async {
+    final probe = http.Request('GET', uri)
+      ..headers.addAll(headers)
+      ..headers[HttpHeaders.rangeHeader] = 'bytes=0-0';
+    final response = await client.send(probe);
+
+    if (response.statusCode == HttpStatus.partialContent) {
+      final total = _parseContentRangeTotal(
+        response.headers[HttpHeaders.contentRangeHeader],
+      );
+      await response.stream.drain<void>();
+      if (total != null) {
+        _totalBytes = total;
+        _validator = _strongValidator(response.headers);
+        return _runRanged(client, total);
+      }
+      // Range answered without a usable size; refetch as one stream.
+      final full = http.Request('GET', uri)..headers.addAll(headers);
+      return _runSequential(await client.send(full));
+    }
+    return _runSequential(response);
+  }
+
+  Future<String?> _runRanged(http.Client client, int total) async {
+    final chunkCount = total == 0 ? 0 : (total + _chunkSize - 1) ~/ _chunkSize;
+    _completed = List<bool>.filled(chunkCount, false);
+    _hasher = hashing ? Sha256Hasher() : null;
+
+    if (!_restoreManifest(total, chunkCount)) {
+      _discardPart();
+      final raf = partFile.openSync(mode: FileMode.write);
+      try {
+        // Preallocate so every connection can write at its own offset.
+        raf.truncateSync(total);
+      } finally {
+        raf.closeSync();
+      }
+      _writeManifest();
+    }
+
+    for (var i = 0; i < chunkCount; i++) {
+      if (_completed[i]) _received += _chunkLength(i, total);
+    }
+    _resumed = _received;
+    _report(force: true);
+    // Hash the restored prefix while the remaining chunks download.
+    _scheduleBookkeeping();
+
+    final pending = Queue<int>.of([
+      for (var i = 0; i < chunkCount; i++)
+        if (!_completed[i]) i,
+    ]);
+    Object? failure;
+    StackTrace? failureStack;
+
+    Future<void> worker() async {
+      final raf = await partFile.open(mode: FileMode.append);
+      try {
+        while (failure == null && pending.isNotEmpty) {
+          final index = pending.removeFirst();
+          try {
+            await _fetchChunk(client, raf, index, total);
+          } catch (e, st) {
+            failure ??= e;
+            failureStack ??= st;
+            return;
+          }
+          _completed[index] = true;
+          _scheduleBookkeeping();
+        }
+      } finally {
+        await raf.close();
+      }
+    }
+
+    final workers = pending.length < downloader.connections
+        ? pending.length
+        : downloader.connections;
+    await Future.wait([for (var i = 0; i < workers; i++) worker()]);
+    await _bookkeeping;
+
+    final error = failure;
+    if (error != null) {
+      if (error is _RemoteChangedException) discard();
+      Error.throwWithStackTrace(error, failureStack!);
+    }
+    _report(force: true);
+    return _hasher?.close();
+  }
+
+  Future<void> _fetchChunk(
+    http.Client client,
+    RandomAccessFile raf,
+    int index,
+    int total,
+  ) async {
+    final end = index * _chunkSize + _chunkLength(index, total);
+    var offset = index * _chunkSize;
+    var attempt = 0;
+    while (true) {
+      final request = http.Request('GET', uri)
+        ..headers.addAll(headers)
+        ..headers[HttpHeaders.rangeHeader] = 'bytes=$offset-${end - 1}';
+      final validator = _validator;
+      if (validator != null) {
+        request.headers[HttpHeaders.ifRangeHeader] = validator;
+      }
+
+      try {
+        final response = await client.send(request);
+        if (response.statusCode == HttpStatus.ok) {
+          // If-Range failed: the resource no longer matches the manifest.
+          // Drop the full body instead of draining it.
+          await response.stream.listen(null).cancel();
+          throw _RemoteChangedException(uri);
+        }
+        if (response.statusCode != HttpStatus.partialContent) {
+          await response.stream.drain<void>();
+          throw HttpException(
+            'Range request failed (HTTP ${response.statusCode})',
+            uri: uri,
+          );
+        }
+
+        await raf.setPosition(offset);
+        await for (final data in response.stream) {
+          if (offset + data.length > end) {
+            throw HttpException(
+              'Server sent more data than requested',
+              uri: uri,
+            );
+          }
+          await raf.writeFrom(data);
+          offset += data.length;
+          _received += data.length;
+          _report();
+        }
+        if (offset != end) {
+          throw HttpException('Connection closed early', uri: uri);
+        }
+        // The manifest only lists chunks that are durably on disk.
+        await raf.flush();
+        return;
+      } on _RemoteChangedException {
+        rethrow;
+      } catch (_) {
+        attempt++;
+        if (attempt >= downloader.maxAttempts) rethrow;
+        // Bytes written so far stay valid; the retry resumes at [offset].
+        final backoff = downloader.retryDelay * (1 << (attempt - 1));
+        await Future<void>.delayed(backoff);
+      }
+    }
+  }
+
+  Future<String?> _runSequential(http.StreamedResponse response) async {
+    if (response.statusCode != HttpStatus.ok) {
+      await response.stream.drain<void>();
+      throw HttpException(
+        'Failed to download model (HTTP ${response.statusCode})',
+        uri: uri,
+      );
+    }
+    final length = response.contentLength;
+    _totalBytes = length != null && length > 0 ? length : null;
+    // No range support means no resume: start over.
+    discard();
+
+    final hasher = hashing ? Sha256Hasher() : null;
+    final sink = partFile.openWrite();
+    try {
+      await for (final data in response.stream) {
+        sink.add(data);
+        hasher?.add(data);
+        _received += data.length;
+        _report();
+      }
+      await sink.flush();
+    } finally {
+      await sink.close();
+    }
+    final expected = _totalBytes;
+    if (expected != null && _received != expected) {
+      throw HttpException(
+        'Connection closed early ($_received of $expected bytes)',
+        uri: uri,
+      );
+    }
+    _report(force: true);
+    return hasher?.close();
+  }
+
+  int _chunkLength(int index, int total) {
+    final start = index * _chunkSize;
+    final remaining = total - start;
+    return remaining < _chunkSize ? remaining : _chunkSize;
+  }
+
+  /// Hashes newly contiguous chunks and persists the manifest, one update at
+  /// a time so the manifest never runs ahead of the data it describes.
+  void _scheduleBookkeeping() {
+    _bookkeeping = _bookkeeping.then((_) async {
+      await _advanceHash();
+      _writeManifest();
+    });
+  }
+
+  Future<void> _advanceHash() async {
+    final hasher = _hasher;
+    final total = _totalBytes!;
+    if (hasher == null) {
+      return;
+    }
+    if (_hashedChunks >= _completed.length || !_completed[_hashedChunks]) {
+      return;
+    }
+    final raf = await partFile.open();
+    try {
+      final buffer = Uint8List(_hashReadSize);
+      while (_hashedChunks < _completed.length && _completed[_hashedChunks]) {
+        var position = _hashedChunks * _chunkSize;
+        final end = position + _chunkLength(_hashedChunks, total);
+        await raf.setPosition(position);
+        while (position < end) {
+          final want = end - position < _hashReadSize
+              ? end - position
+              : _hashReadSize;
+          final read = await raf.readInto(buffer, 0, want);
+          if (read <= 0) {
+            throw FileSystemException('Unexpected end of file', partFile.path);
+          }
+          hasher.add(buffer, 0, read);
+          position += read;
+        }
+        _hashedChunks++;
+      }
+    } finally {
+      await raf.close();
+    }
+  }
+
+  bool _restoreManifest(int total, int chunkCount) {
+    try {
+      if (!manifestFile.existsSync() || !partFile.existsSync()) return false;
+      if (partFile.lengthSync() != total) return false;
+      final json = jsonDecode(manifestFile.readAsStringSync());
+      if (json is! Map ||
+          json['url'] != uri.toString() ||
+          json['total_bytes'] != total ||
+          json['chunk_size'] != _chunkSize ||
+          json['validator'] != _validator) {
+        return false;
+      }
+      final completed = json['completed'];
+      final hashedChunks = json['hashed_chunks'];
+      if (completed is! List || hashedChunks is! int) return false;
+
+      for (final index in completed) {
+        if (index is int && index >= 0 && index < chunkCount) {
+          _completed[index] = true;
+        }
+      }
+      if (hashing) {
+        // Without a usable saved state the restored chunks are rehashed
+        // from disk instead of refetched.
+        final hasher = Sha256Hasher.fromJson(json['hash']);
+        final hashedBytes = hashedChunks * _chunkSize;
+        if (hasher != null &&
+            hashedChunks <= chunkCount &&
+            _completed.take(hashedChunks).every((done) => done) &&
+            hasher.length == (hashedBytes > total ? total : hashedBytes)) {
+          _hasher = hasher;
+          _hashedChunks = hashedChunks;
+        }
+      }
+      return true;
+    } on FormatException {
+      return false;
+    } on FileSystemException {
+      return false;
+    }
+  }
+
+  void _writeManifest() {
+    final manifest = <String, Object?>{
+      'url': uri.toString(),
+      'total_bytes': _totalBytes,
+      'chunk_size': _chunkSize,
+      'validator': _validator,
+      'completed': [
+        for (var i = 0; i < _completed.length; i++)
+          if (_completed[i]) i,
+      ],
+      'hashed_chunks': _hashedChunks,
+      if (_hasher != null) 'hash': _hasher!.toJson(),
+    };
+    final temp = File('${manifestFile.path}.tmp');
+    temp.writeAsStringSync(jsonEncode(manifest), flush: true);
+    temp.renameSync(manifestFile.path);
+  }
+
+  void _report({bool force = false}) {
+    final callback = onProgress;
+    if (callback == null) return;
+    final step = _received - _lastReported;
+    if (!force && step < ModelDownloader._progressStepBytes) return;
+    _lastReported = _received;
+    callback(
+      ModelDownloadProgress(
+        receivedBytes: _received,
+        totalBytes: _totalBytes,
+        resumedBytes: _resumed,
+      ),
+    );
+  }
+
+  void _discardPart() {
+    if (partFile.existsSync()) partFile.deleteSync();
+  }
+
+  /// Deletes the manifest once the part file has been promoted.
+  void discardManifest() {
+    if (manifestFile.existsSync()) manifestFile.deleteSync();
+  }
+
+  /// Deletes all partial state so the next attempt starts from scratch.
+  void discard() {
+    _discardPart();
+    discardManifest();
+  }
+}
+
+/// Returns an `If-Range` validator; weak ETags never match and would force
+/// a full refetch of every chunk.
+String? _strongValidator(Map<String, String> headers) {
+  final etag = headers[HttpHeaders.etagHeader];
+  if (etag != null && !etag.startsWith('W/')) return etag;
+  return headers[HttpHeaders.lastModifiedHeader];
+}
+
+int? _parseContentRangeTotal(String? header) {
+  if (header == null) return null;
+  final slash = header.lastIndexOf('/');
+  if (slash < 0) return null;
+  return int.tryParse(header.substring(slash + 1).trim());
+}
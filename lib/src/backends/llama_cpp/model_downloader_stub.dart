@@ -0,0 +1,28 @@
+// coverage:ignore-file
+// Stub for web platforms, which cannot write model files to local storage.
+import 'package:http/http.dart' as http;
+
+import '../../core/download/model_download_progress.dart';
+
+/// Unsupported on web; use `LlamaEngine.loadModelFromUrl` instead.
+class ModelDownloader {
+  /// Creates a downloader stub.
+  ModelDownloader({
+    int connections = 4,
+    int chunkSize = 32 * 1024 * 1024,
+    int maxAttempts = 4,
+    Duration retryDelay = const Duration(milliseconds: 500),
+    http.Client Function()? clientFactory,
+  });
+
+  /// Always throws [UnsupportedError].
+  Future<Never> download(
+    Uri uri,
+    String destinationPath, {
+    String? sha256,
+    Map<String, String> headers = const {},
+    void Function(ModelDownloadProgress progress)? onProgress,
+  }) {
+    throw UnsupportedError('ModelDownloader is not supported on web');
+  }
+}
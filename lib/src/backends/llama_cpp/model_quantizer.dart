@@ -0,0 +1,177 @@
+import 'dart:async';
+import 'dart:convert';
+import 'dart:ffi';
+import 'dart:io';
+import 'dart:isolate';
+
+import 'package:ffi/ffi.dart';
+import 'package:path/path.dart' as path;
+
+import '../../core/download/sha256_hasher.dart';
+import '../../core/quantization/quantization_params.dart';
+import '../../core/quantization/quantization_planner.dart';
+import '../../core/quantization/quantization_type.dart';
+import 'bindings.dart';
+import 'gguf_file_source.dart';
+
+/// Returns where the [type] quantization of the model at [sourcePath] is
+/// cached under [cacheDirectory].
+///
+/// The name includes the SHA-256 of the source path, size and modification
+/// time, so replacing the source model invalidates its quantized copies and
+/// distinct sources never share a cache file.
+String quantizedModelCachePath(
+  String cacheDirectory,
+  String sourcePath,
+  int sourceSize,
+  int sourceModifiedMicros,
+  QuantizationType type,
+) {
+  final identity = '${path.absolute(sourcePath)}|$sourceSize'
+      '|$sourceModifiedMicros|${type.label}';
+  final digest = Sha256Hasher.digestOf(utf8.encode(identity));
+  final stem = path.basenameWithoutExtension(sourcePath);
+  return path.join(
+    cacheDirectory,
+    'quantized',
+    '$stem-$digest.${type.label}.gguf',
+  );
+}
+
+/// Quantizes the GGUF model at [inputPath] into [outputPath].
+///
+/// `llama_model_quantize` blocks until the whole file is written and offers
+/// neither progress nor abort hooks, so it runs on a helper isolate while
+/// this function reports progress from the size of the partial output
+/// against the size predicted from the tensor table. When [isCancelled]
+/// turns true the returned future fails right away; the native call cannot
+/// be interrupted, so its partial output is deleted once it returns.
+///
+/// The output is written next to [outputPath] and renamed into place on
+/// success, so [outputPath] never holds a partial model.
+Future<void> quantizeGgufFile(
+  String inputPath,
+  String outputPath,
+  QuantizationParams params, {
+  bool Function()? isCancelled,
+  void Function(double progress)? onProgress,
+  Duration pollInterval = const Duration(milliseconds: 250),
+}) async {
+  final source = inspectGgufFile(inputPath);
+  if (!source.isComplete) {
+    throw Exception("Model file is truncated: $inputPath");
+  }
+  final expectedBytes = predictQuantizedModel(source, params).fileSize;
+  final outputType = _typeId(params.outputTensorType);
+  final embeddingType = _typeId(params.tokenEmbeddingType);
+
+  Directory(path.dirname(outputPath)).createSync(recursive: true);
+  final partial = File(
+    '$outputPath.${pid}_${DateTime.now().microsecondsSinceEpoch}.part',
+  );
+
+  final job = _quantizeOffWorker(
+    inputPath,
+    partial.path,
+    params.type.fileType,
+    params.threads,
+    outputType,
+    embeddingType,
+    params.allowRequantize,
+    params.quantizeOutputTensor,
+    params.pure,
+  );
+
+  try {
+    while (!await _completesWithin(job, pollInterval)) {
+      if (isCancelled?.call() ?? false) {
+        unawaited(
+          job.then<void>((_) {}, onError: (Object _) {}).whenComplete(
+            () => _deleteQuietly(partial),
+          ),
+        );
+        throw Exception("Quantization cancelled");
+      }
+      if (onProgress != null && expectedBytes > 0) {
+        final written = partial.existsSync() ? partial.lengthSync() : 0;
+        // The header is rewritten last, so hold back the final percent.
+        final fraction = written / expectedBytes;
+        onProgress(fraction > 0.99 ? 0.99 : fraction);
+      }
+    }
+
+    final status = await job;
+    if (status != 0) {
+      throw Exception("llama_model_quantize failed with status $status");
+    }
+    partial.renameSync(outputPath);
+    onProgress?.call(1.0);
+  } catch (_) {
+    if (!(isCancelled?.call() ?? false)) _deleteQuietly(partial);
+    rethrow;
+  }
+}
+
+Future<bool> _completesWithin(Future<int> job, Duration timeout) {
+  return Future.any([
+    job.then((_) => true),
+    Future.delayed(timeout, () => false),
+  ]);
+}
+
+void _deleteQuietly(File file) {
+  try {
+    if (file.existsSync()) file.deleteSync();
+  } on FileSystemException {
+    // Left for the next cache cleanup.
+  }
+}
+
+int? _typeId(String? name) {
+  if (name == null) return null;
+  final id = ggmlTypeIdForName(name);
+  if (id == null) {
+    throw ArgumentError.value(name, 'name', 'Unknown ggml tensor type');
+  }
+  return id;
+}
+
+// Only the arguments are captured, so the closure sent to the helper
+// isolate holds plain values.
+Future<int> _quantizeOffWorker(
+  String inputPath,
+  String outputPath,
+  int fileType,
+  int threads,
+  int? outputType,
+  int? embeddingType,
+  bool allowRequantize,
+  bool quantizeOutputTensor,
+  bool pure,
+) {
+  return Isolate.run(() {
+    final defaults = llama_model_quantize_default_params();
+    final params = calloc<llama_model_quantize_params>();
+    final inputPtr = inputPath.toNativeUtf8();
+    final outputPtr = outputPath.toNativeUtf8();
+    try {
+      params.ref
+        ..nthread = threads
+        ..ftypeAsInt = fileType
+        ..output_tensor_typeAsInt =
+            outputType ?? defaults.output_tensor_typeAsInt
+        ..token_embedding_typeAsInt =
+            embeddingType ?? defaults.token_embedding_typeAsInt
+        ..allow_requantize = allowRequantize
+        ..quantize_output_tensor = quantizeOutputTensor
+        ..only_copy = false
+        ..pure = pure
+        ..keep_split = false;
+      return llama_model_quantize(inputPtr.cast(), outputPtr.cast(), params);
+    } finally {
+      calloc.free(params);
+      malloc.free(inputPtr);
+      malloc.free(outputPtr);
+    }
+  });
+}
@@ -0,0 +1,170 @@
+import 'dart:convert';
+import 'dart:typed_data';
+
+import '../../core/download/sha256_hasher.dart';
+
+/// Returns a stable cache key for in-memory media [bytes].
+///
+/// Caches are shared by every request on a model, so keys use SHA-256: a
+/// client must not be able to craft media that collides with another
+/// client's and be served its cached embedding.
+String mediaBytesCacheKey(String kind, List<int> bytes) {
+  return '$kind:b:${Sha256Hasher.digestOf(bytes)}';
+}
+
+/// Returns a stable cache key for raw PCM [samples].
+String mediaSamplesCacheKey(Float32List samples) {
+  final bytes = samples.buffer.asUint8List(
+    samples.offsetInBytes,
+    samples.lengthInBytes,
+  );
+  return 'audio:s:${Sha256Hasher.digestOf(bytes)}';
+}
+
+/// Returns a cache key for a media file identified by [path].
+///
+/// File size and modification time are folded in so edited files are
+/// re-decoded instead of served from a stale entry.
+String mediaFileCacheKey(
+  String kind,
+  String path,
+  int length,
+  int modifiedMicros,
+) {
+  final pathHash = Sha256Hasher.digestOf(utf8.encode(path));
+  return '$kind:f:$pathHash:$length:$modifiedMicros';
+}
+
+/// Identity of one evaluated multimodal prompt chunk.
+///
+/// Text chunks are compared token-by-token; media chunks are compared by
+/// their content-derived id.
+class MultimodalChunkSignature {
+  /// Text token ids, or `null` for media chunks.
+  final List<int>? textTokens;
+
+  /// Content id for media chunks, or `null` for text chunks.
+  final String? mediaId;
+
+  /// Number of KV positions this chunk occupies.
+  final int nPos;
+
+  /// Creates a text chunk signature.
+  MultimodalChunkSignature.text(List<int> tokens)
+    : textTokens = List<int>.unmodifiable(tokens),
+      mediaId = null,
+      nPos = tokens.length;
+
+  /// Creates a media chunk signature.
+  const MultimodalChunkSignature.media(String this.mediaId, this.nPos)
+    : textTokens = null;
+
+  /// Whether this signature describes a text chunk.
+  bool get isText => textTokens != null;
+}
+
+/// Result of matching a new chunk list against the cached one.
+class MultimodalPrefixMatch {
+  /// Index of the first chunk that must be (partially) evaluated.
+  final int chunkIndex;
+
+  /// Number of leading tokens of [chunkIndex] that are already in the KV
+  /// cache. Always zero for media chunks.
+  final int tokenOffset;
+
+  /// KV position at which evaluation resumes.
+  final int reusedPositions;
+
+  /// Creates a prefix match result.
+  const MultimodalPrefixMatch({
+    required this.chunkIndex,
+    required this.tokenOffset,
+    required this.reusedPositions,
+  });
+
+  /// A match that reuses nothing.
+  static const MultimodalPrefixMatch none = MultimodalPrefixMatch(
+    chunkIndex: 0,
+    tokenOffset: 0,
+    reusedPositions: 0,
+  );
+}
+
+/// Finds the longest reusable prefix between [cached] and [next].
+///
+/// Media chunks only match as a whole. An exact full replay is reported as
+/// [MultimodalPrefixMatch.none] so the prompt is re-ingested, mirroring the
+/// text-only prefix reuse policy.
+MultimodalPrefixMatch matchMultimodalPrefix(
+  List<MultimodalChunkSignature>? cached,
+  List<MultimodalChunkSignature> next,
+) {
+  if (cached == null || cached.isEmpty || next.isEmpty) {
+    return MultimodalPrefixMatch.none;
+  }
+
+  var positions = 0;
+  var index = 0;
+  while (index < cached.length && index < next.length) {
+    final previous = cached[index];
+    final current = next[index];
+
+    if (previous.isText && current.isText) {
+      final a = previous.textTokens!;
+      final b = current.textTokens!;
+      final limit = a.length < b.length ? a.length : b.length;
+      var shared = 0;
+      while (shared < limit && a[shared] == b[shared]) {
+        shared++;
+      }
+      if (shared < b.length || a.length != b.length) {
+        return _partialMatch(next, index, shared, positions + shared);
+      }
+      positions += current.nPos;
+      index++;
+      continue;
+    }
+
+    if (!previous.isText &&
+        !current.isText &&
+        previous.mediaId == current.mediaId &&
+        previous.nPos == current.nPos) {
+      positions += current.nPos;
+      index++;
+      continue;
+    }
+
+    return _partialMatch(next, index, 0, positions);
+  }
+
+  if (index >= next.length) {
+    // Full replay (or next is a strict prefix of cached): re-ingest.
+    return MultimodalPrefixMatch.none;
+  }
+
+  return _partialMatch(next, index, 0, positions);
+}
+
+MultimodalPrefixMatch _partialMatch(
+  List<MultimodalChunkSignature> next,
+  int index,
+  int tokenOffset,
+  int positions,
+) {
+  var resumeIndex = index;
+  var resumeOffset = tokenOffset;
+  final tokens = next[resumeIndex].textTokens;
+  if (tokens != null && resumeOffset >= tokens.length) {
+    // The whole text chunk is cached; resume at the following chunk.
+    resumeIndex++;
+    resumeOffset = 0;
+  }
+  if (positions <= 0 || resumeIndex >= next.length) {
+    return MultimodalPrefixMatch.none;
+  }
+  return MultimodalPrefixMatch(
+    chunkIndex: resumeIndex,
+    tokenOffset: resumeOffset,
+    reusedPositions: positions,
+  );
+}
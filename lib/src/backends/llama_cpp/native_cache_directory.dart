@@ -0,0 +1,43 @@
+import 'dart:io';
+
+import 'package:path/path.dart' as path;
+
+/// Returns the directory where native backends persist derived artifacts
+/// such as thread tuning results.
+///
+/// Follows platform conventions (`XDG_CACHE_HOME` / `~/.cache` on Linux,
+/// `~/Library/Caches` on macOS, `%LOCALAPPDATA%` on Windows) and falls back
+/// to the system temp directory when no home directory is known, as on
+/// mobile sandboxes. [environment] and [operatingSystem] default to the
+/// current process values and exist for testing.
+String defaultNativeCacheDirectory({
+  Map<String, String>? environment,
+  String? operatingSystem,
+}) {
+  final env = environment ?? Platform.environment;
+  final os = operatingSystem ?? Platform.operatingSystem;
+
+  String? base;
+  switch (os) {
+    case 'windows':
+      base = env['LOCALAPPDATA'] ?? env['APPDATA'];
+    case 'macos':
+      final home = env['HOME'];
+      if (home != null && home.isNotEmpty) {
+        base = path.join(home, 'Library', 'Caches');
+      }
+    case 'linux':
+      final xdg = env['XDG_CACHE_HOME'];
+      final home = env['HOME'];
+      if (xdg != null && xdg.isNotEmpty) {
+        base = xdg;
+      } else if (home != null && home.isNotEmpty) {
+        base = path.join(home, '.cache');
+      }
+  }
+
+  if (base == null || base.isEmpty) {
+    base = Directory.systemTemp.path;
+  }
+  return path.join(base, 'llamadart');
+}
@@ -0,0 +1,98 @@
+import 'dart:async';
+import 'dart:isolate';
+
+/// Runs [computation] on a helper isolate, or inline when no helper isolate
+/// can be spawned.
+///
+/// Only a failed spawn falls back to running inline; once the helper isolate
+/// exists, failures of [computation] are rethrown and never retried, so a
+/// failing job does not run a second time on the caller's isolate. Errors
+/// and results that cannot be sent back arrive as a [RemoteError].
+/// [computation] should only capture sendable values.
+Future<R> runOffWorker<R>(R Function() computation) async {
+  final completer = Completer<_Outcome<R>>();
+  final port = RawReceivePort();
+  port.handler = (Object? message) {
+    port.close();
+    completer.complete(
+      message is _Outcome<R>
+          ? message
+          : _Outcome<R>._(
+              null,
+              RemoteError('Helper isolate exited without a result', ''),
+              null,
+            ),
+    );
+  };
+
+  try {
+    await Isolate.spawn<_OffWorkerJob<R>>(
+      _runOffWorkerJob<R>,
+      _OffWorkerJob<R>(computation, port.sendPort),
+      onExit: port.sendPort,
+      errorsAreFatal: true,
+    );
+  } on Object {
+    // The helper isolate could not be spawned; the job has not run yet.
+    port.close();
+    return computation();
+  }
+  return (await completer.future).unwrap();
+}
+
+class _OffWorkerJob<R> {
+  final R Function() computation;
+  final SendPort replyPort;
+
+  _OffWorkerJob(this.computation, this.replyPort);
+}
+
+void _runOffWorkerJob<R>(_OffWorkerJob<R> job) {
+  final outcome = _Outcome.capture(job.computation);
+  try {
+    Isolate.exit(job.replyPort, outcome);
+  } on Object catch (e) {
+    // The value or error holds something that cannot cross isolates.
+    final failure = outcome.error;
+    Isolate.exit(
+      job.replyPort,
+      _Outcome<R>._(
+        null,
+        RemoteError(
+          failure != null ? '$failure' : 'Result is not sendable: $e',
+          outcome.stackTrace ?? '',
+        ),
+        null,
+      ),
+    );
+  }
+}
+
+/// Result of a helper-isolate job, so its errors reach the caller as data
+/// rather than as failures of the isolate.
+class _Outcome<R> {
+  final R? value;
+  final Object? error;
+  final String? stackTrace;
+
+  _Outcome._(this.value, this.error, this.stackTrace);
+
+  static _Outcome<T> capture<T>(T Function() computation) {
+    try {
+      return _Outcome<T>._(computation(), null, null);
+    } catch (e, stackTrace) {
+      return _Outcome<T>._(null, e, stackTrace.toString());
+    }
+  }
+
+  R unwrap() {
+    final failure = error;
+    if (failure != null) {
+      Error.throwWithStackTrace(
+        failure,
+        StackTrace.fromString(stackTrace ?? ''),
+      );
+    }
+    return value as R;
+  }
+}
@@ -0,0 +1,77 @@
+/// Proposes draft tokens by looking up the latest n-gram of a token history
+/// in earlier parts of the same history.
+///
+/// This is prompt-lookup decoding: when the output copies from the prompt
+/// (code edits, quoted sources, rewritten JSON), the tokens that followed the
+/// last occurrence of the current suffix are a good guess for what comes
+/// next. No draft model is needed; the index only holds token positions.
+class PromptLookupDrafter {
+  /// Longest suffix n-gram that is looked up.
+  final int maxNgramSize;
+
+  /// Shortest suffix n-gram that is looked up before giving up.
+  final int minNgramSize;
+
+  final List<int> _history = <int>[];
+
+  // _positions[n - minNgramSize] maps the hash of an n-gram to the index of
+  // the token that followed its most recent occurrence.
+  final List<Map<int, int>> _positions;
+
+  /// Creates a drafter whose history starts with [promptTokens].
+  PromptLookupDrafter({
+    this.maxNgramSize = 3,
+    this.minNgramSize = 1,
+    Iterable<int> promptTokens = const <int>[],
+  }) : assert(minNgramSize >= 1 && maxNgramSize >= minNgramSize),
+       _positions = List<Map<int, int>>.generate(
+         maxNgramSize - minNgramSize + 1,
+         (_) => <int, int>{},
+       ) {
+    promptTokens.forEach(add);
+  }
+
+  /// Number of tokens in the history.
+  int get length => _history.length;
+
+  /// Appends [token] to the history.
+  void add(int token) {
+    final end = _history.length;
+    for (var n = minNgramSize; n <= maxNgramSize && n <= end; n++) {
+      _positions[n - minNgramSize][_hash(end - n, n)] = end;
+    }
+    _history.add(token);
+  }
+
+  /// Returns up to [maxTokens] tokens that followed the most recent earlier
+  /// occurrence of the longest matching suffix n-gram, or an empty list.
+  List<int> draft(int maxTokens) {
+    if (maxTokens <= 0) return const <int>[];
+    final length = _history.length;
+    for (var n = maxNgramSize; n >= minNgramSize; n--) {
+      if (n > length) continue;
+      final start = length - n;
+      final follower = _positions[n - minNgramSize][_hash(start, n)];
+      if (follower == null || !_matches(follower - n, start, n)) continue;
+      final end = follower + maxTokens < length ? follower + maxTokens : length;
+      return _history.sublist(follower, end);
+    }
+    return const <int>[];
+  }
+
+  int _hash(int start, int n) {
+    // FNV-1a over token ids; collisions are ruled out by _matches.
+    var hash = 0xcbf29ce484222325;
+    for (var i = start; i < start + n; i++) {
+      hash = (hash ^ _history[i]) * 0x100000001b3;
+    }
+    return hash;
+  }
+
+  bool _matches(int a, int b, int n) {
+    for (var i = 0; i < n; i++) {
+      if (_history[a + i] != _history[b + i]) return false;
+    }
+    return true;
+  }
+}
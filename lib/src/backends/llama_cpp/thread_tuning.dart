@@ -0,0 +1,126 @@
+import 'dart:convert';
+import 'dart:io';
+
+/// Thread counts chosen by calibration for one host/model combination.
+class ThreadTuningResult {
+  /// Threads used for single-token decode (`n_threads`).
+  final int decodeThreads;
+
+  /// Threads used for prompt prefill batches (`n_threads_batch`).
+  final int batchThreads;
+
+  /// Creates a tuning result.
+  const ThreadTuningResult({
+    required this.decodeThreads,
+    required this.batchThreads,
+  });
+
+  /// Serializes this result for the on-disk cache.
+  Map<String, Object> toJson() => {
+    'decode_threads': decodeThreads,
+    'batch_threads': batchThreads,
+  };
+
+  /// Parses a cached result, returning `null` for malformed entries.
+  static ThreadTuningResult? fromJson(Object? json) {
+    if (json is! Map) return null;
+    final decode = json['decode_threads'];
+    final batch = json['batch_threads'];
+    if (decode is! int || batch is! int || decode <= 0 || batch <= 0) {
+      return null;
+    }
+    return ThreadTuningResult(decodeThreads: decode, batchThreads: batch);
+  }
+}
+
+/// Returns the thread counts worth calibrating on a host with
+/// [logicalCpus] logical CPUs.
+///
+/// Quarters of the logical CPU count cover the usual optima: physical core
+/// count on SMT hosts, one socket on dual-socket hosts, and all CPUs when
+/// memory bandwidth is not the bottleneck.
+List<int> threadCountCandidates(int logicalCpus) {
+  final cpus = logicalCpus < 1 ? 1 : logicalCpus;
+  final candidates = <int>{};
+  for (var quarter = 1; quarter <= 4; quarter++) {
+    final count = (cpus * quarter / 4).round();
+    candidates.add(count < 1 ? 1 : count);
+  }
+  return candidates.toList()..sort();
+}
+
+/// Picks the fastest thread count from [elapsedMicros].
+///
+/// Counts within [tolerance] of the fastest are considered equal and the
+/// smallest of them wins, leaving headroom for other work on the host.
+int fastestThreadCount(
+  Map<int, int> elapsedMicros, {
+  double tolerance = 0.03,
+}) {
+  if (elapsedMicros.isEmpty) {
+    throw ArgumentError.value(elapsedMicros, 'elapsedMicros', 'is empty');
+  }
+  final best = elapsedMicros.values.reduce((a, b) => a < b ? a : b);
+  final limit = best * (1 + tolerance);
+  final counts = elapsedMicros.keys.toList()..sort();
+  return counts.firstWhere((count) => elapsedMicros[count]! <= limit);
+}
+
+/// Builds the cache key for a tuning result.
+///
+/// Thread optima depend on the host CPU, on the model architecture, size and
+/// quantization (all part of [modelDescription] and [modelSizeBytes]), and
+/// on how much of the model runs on the GPU.
+String threadTuningCacheKey({
+  required String host,
+  required int logicalCpus,
+  required String modelDescription,
+  required int modelSizeBytes,
+  required int gpuLayers,
+}) {
+  return '$host/$logicalCpus|$modelDescription|$modelSizeBytes'
+      '|gpu=$gpuLayers';
+}
+
+/// JSON file backed cache of [ThreadTuningResult]s.
+///
+/// Read and write failures are ignored: a missing or corrupt cache only
+/// means calibration runs again.
+class ThreadTuningCache {
+  /// File holding the cached results.
+  final File file;
+
+  /// Creates a cache stored in [file].
+  ThreadTuningCache(this.file);
+
+  /// Returns the cached result for [key], if any.
+  ThreadTuningResult? lookup(String key) {
+    return ThreadTuningResult.fromJson(_read()[key]);
+  }
+
+  /// Stores [result] under [key].
+  void store(String key, ThreadTuningResult result) {
+    final entries = _read()..[key] = result.toJson();
+    try {
+      file.parent.createSync(recursive: true);
+      final temp = File('${file.path}.tmp');
+      temp.writeAsStringSync(jsonEncode(entries), flush: true);
+      temp.renameSync(file.path);
+    } on FileSystemException {
+      // Best effort; the next load simply recalibrates.
+    }
+  }
+
+  Map<String, Object?> _read() {
+    try {
+      if (!file.existsSync()) return <String, Object?>{};
+      final decoded = jsonDecode(file.readAsStringSync());
+      if (decoded is Map<String, Object?>) return decoded;
+    } on FormatException {
+      // Corrupt cache; start over.
+    } on FileSystemException {
+      // Unreadable cache; start over.
+    }
+    return <String, Object?>{};
+  }
+}
@@ -47,7 +47,9 @@ void llamaWorkerEntry(SendPort initialSendPort) {
               message.modelPath,
               message.modelParams,
             );
-            message.sendPort.send(HandleResponse(handle));
+            message.sendPort.send(
+              ModelLoadResponse(handle, service.getModelInfo(handle)),
+            );
 
           case LogLevelRequest():
             service.setLogLevel(message.logLevel);
@@ -108,6 +110,47 @@ void llamaWorkerEntry(SendPort initialSendPort) {
             );
             message.sendPort.send(TokenizeResponse(tokens));
 
+          case TokenizeBatchRequest():
+            // Shards run on helper isolates; other requests keep flowing
+            // while this one is awaited.
+            if (message.countOnly) {
+              final counts = await service.countTokensBatch(
+                message.modelHandle,
+                message.texts,
+                message.addSpecial,
+                threads: message.threads,
+              );
+              message.sendPort.send(
+                TokenCountBatchResponse(
+                  TransferableTypedData.fromList([counts]),
+                ),
+              );
+            } else {
+              final batch = await service.tokenizeBatch(
+                message.modelHandle,
+                message.texts,
+                message.addSpecial,
+                threads: message.threads,
+              );
+              message.sendPort.send(
+                TokenizeBatchResponse(
+                  TransferableTypedData.fromList([batch.tokens]),
+                  TransferableTypedData.fromList([batch.offsets]),
+                ),
+              );
+            }
+
+          case QuantizeRequest():
+            await service.quantizeModel(
+              message.inputPath,
+              message.outputPath,
+              message.params,
+              message.cancelTokenAddress,
+              onProgress: (progress) =>
+                  message.sendPort.send(QuantizeProgressResponse(progress)),
+            );
+            message.sendPort.send(DoneResponse());
+
           case DetokenizeRequest():
             final text = service.detokenize(
               message.modelHandle,
@@ -129,6 +172,25 @@ void llamaWorkerEntry(SendPort initialSendPort) {
             );
             message.sendPort.send(DoneResponse());
 
+          case LoraStatsRequest():
+            final stats = service.getLoraSwitchStats(message.contextHandle);
+            message.sendPort.send(LoraStatsResponse(stats));
+
+          case PromptLookupStatsRequest():
+            final stats = service.getPromptLookupStats(message.contextHandle);
+            message.sendPort.send(PromptLookupStatsResponse(stats));
+
+          case VocabPieceTableRequest():
+            final table = service.getVocabPieceTable(message.modelHandle);
+            // The worker keeps its table; transfer a copy to the caller.
+            message.sendPort.send(
+              VocabPieceTableResponse(
+                TransferableTypedData.fromList([table.bytes]),
+                TransferableTypedData.fromList([table.offsets]),
+                TransferableTypedData.fromList([table.flags]),
+              ),
+            );
+
           case BackendInfoRequest():
             final info = service.getBackendInfo();
             message.sendPort.send(BackendInfoResponse(info.join(", ")));
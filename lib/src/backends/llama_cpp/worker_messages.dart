@@ -1,8 +1,12 @@
 import 'dart:isolate';
+import '../../core/gguf/gguf_model_info.dart';
 import '../../core/models/inference/model_params.dart';
 import '../../core/models/inference/generation_params.dart';
+import '../../core/models/inference/lora_switch_stats.dart';
+import '../../core/models/inference/prompt_lookup_stats.dart';
 import '../../core/models/chat/content_part.dart';
 import '../../core/models/config/log_level.dart';
+import '../../core/quantization/quantization_params.dart';
 
 /// Base class for all worker requests.
 abstract class WorkerRequest {
@@ -98,6 +102,58 @@ class TokenizeRequest extends WorkerRequest {
   TokenizeRequest(this.modelHandle, this.text, this.addSpecial, super.sendPort);
 }
 
+/// Request to tokenize or count the tokens of many texts.
+class TokenizeBatchRequest extends WorkerRequest {
+  /// The handle of the model.
+  final int modelHandle;
+
+  /// The texts to tokenize.
+  final List<String> texts;
+
+  /// Whether to add special tokens.
+  final bool addSpecial;
+
+  /// Whether to return only per-text token counts.
+  final bool countOnly;
+
+  /// Maximum number of tokenizer threads, or `null` for all CPUs.
+  final int? threads;
+
+  /// Creates a new [TokenizeBatchRequest].
+  TokenizeBatchRequest(
+    this.modelHandle,
+    this.texts,
+    this.addSpecial,
+    this.countOnly,
+    this.threads,
+    super.sendPort,
+  );
+}
+
+/// Request to quantize a model file.
+class QuantizeRequest extends WorkerRequest {
+  /// Path of the source GGUF file.
+  final String inputPath;
+
+  /// Path of the quantized GGUF file to write.
+  final String outputPath;
+
+  /// Quantization options.
+  final QuantizationParams params;
+
+  /// Address of the cancellation flag.
+  final int cancelTokenAddress;
+
+  /// Creates a new [QuantizeRequest].
+  QuantizeRequest(
+    this.inputPath,
+    this.outputPath,
+    this.params,
+    this.cancelTokenAddress,
+    super.sendPort,
+  );
+}
+
 /// Request to detokenize tokens.
 class DetokenizeRequest extends WorkerRequest {
   /// The handle of the model.
@@ -151,6 +207,33 @@ class LoraRequest extends WorkerRequest {
   }) : super(sendPort);
 }
 
+/// Request for LoRA adapter switching statistics.
+class LoraStatsRequest extends WorkerRequest {
+  /// The handle of the context.
+  final int contextHandle;
+
+  /// Creates a new [LoraStatsRequest].
+  LoraStatsRequest(this.contextHandle, super.sendPort);
+}
+
+/// Request for prompt-lookup decoding statistics.
+class PromptLookupStatsRequest extends WorkerRequest {
+  /// The handle of the context.
+  final int contextHandle;
+
+  /// Creates a new [PromptLookupStatsRequest].
+  PromptLookupStatsRequest(this.contextHandle, super.sendPort);
+}
+
+/// Request for the vocabulary piece table of a model.
+class VocabPieceTableRequest extends WorkerRequest {
+  /// The handle of the model.
+  final int modelHandle;
+
+  /// Creates a new [VocabPieceTableRequest].
+  VocabPieceTableRequest(this.modelHandle, super.sendPort);
+}
+
 /// Request for backend information.
 class BackendInfoRequest extends WorkerRequest {
   /// Creates a new [BackendInfoRequest].
@@ -269,6 +352,18 @@ class HandleResponse {
   HandleResponse(this.handle);
 }
 
+/// Response to a [ModelLoadRequest].
+class ModelLoadResponse {
+  /// The handle of the loaded model.
+  final int handle;
+
+  /// The GGUF header parsed during the load, or null if it was not readable.
+  final GgufModelInfo? modelInfo;
+
+  /// Creates a new [ModelLoadResponse].
+  ModelLoadResponse(this.handle, this.modelInfo);
+}
+
 /// Response containing token bytes.
 class TokenResponse {
   /// The generated bytes.
@@ -287,6 +382,36 @@ class TokenizeResponse {
   TokenizeResponse(this.tokens);
 }
 
+/// Response containing a packed batch of tokens.
+class TokenizeBatchResponse {
+  /// Concatenated token IDs (`Int32List`).
+  final TransferableTypedData tokens;
+
+  /// Start offset of each text plus a final end offset (`Uint32List`).
+  final TransferableTypedData offsets;
+
+  /// Creates a new [TokenizeBatchResponse].
+  TokenizeBatchResponse(this.tokens, this.offsets);
+}
+
+/// Response containing per-text token counts.
+class TokenCountBatchResponse {
+  /// Token count of each text (`Int32List`).
+  final TransferableTypedData counts;
+
+  /// Creates a new [TokenCountBatchResponse].
+  TokenCountBatchResponse(this.counts);
+}
+
+/// Progress update of a running quantization.
+class QuantizeProgressResponse {
+  /// Completed fraction in `[0.0, 1.0]`.
+  final double progress;
+
+  /// Creates a new [QuantizeProgressResponse].
+  QuantizeProgressResponse(this.progress);
+}
+
 /// Response containing detokenized text.
 class DetokenizeResponse {
   /// The resulting text.
@@ -305,6 +430,41 @@ class MetadataResponse {
   MetadataResponse(this.metadata);
 }
 
+/// Response containing LoRA adapter switching statistics.
+class LoraStatsResponse {
+  /// The statistics for the requested context.
+  final LoraSwitchStats stats;
+
+  /// Creates a new [LoraStatsResponse].
+  LoraStatsResponse(this.stats);
+}
+
+/// Response containing prompt-lookup decoding statistics.
+class PromptLookupStatsResponse {
+  /// The statistics for the requested context.
+  final PromptLookupStats stats;
+
+  /// Creates a new [PromptLookupStatsResponse].
+  PromptLookupStatsResponse(this.stats);
+}
+
+/// Response carrying the packed arrays of a vocabulary piece table.
+///
+/// The arrays are moved rather than copied between isolates.
+class VocabPieceTableResponse {
+  /// Concatenated piece bytes.
+  final TransferableTypedData bytes;
+
+  /// Piece offsets (`Uint32List`).
+  final TransferableTypedData offsets;
+
+  /// Per-token flags.
+  final TransferableTypedData flags;
+
+  /// Creates a new [VocabPieceTableResponse].
+  VocabPieceTableResponse(this.bytes, this.offsets, this.flags);
+}
+
 /// Response containing the context size.
 class GetContextSizeResponse {
   /// The context size.
@@ -0,0 +1,31 @@
+/// Progress snapshot of a model download.
+class ModelDownloadProgress {
+  /// Bytes present in the partial file, including bytes from earlier runs.
+  final int receivedBytes;
+
+  /// Expected total size, or `null` when the server did not report it.
+  final int? totalBytes;
+
+  /// Bytes that were already on disk when the download started, from an
+  /// interrupted run or an existing file.
+  final int resumedBytes;
+
+  /// Creates a progress snapshot.
+  const ModelDownloadProgress({
+    required this.receivedBytes,
+    this.totalBytes,
+    this.resumedBytes = 0,
+  });
+
+  /// Fraction in `[0.0, 1.0]`, or `null` when [totalBytes] is unknown.
+  double? get fraction {
+    final total = totalBytes;
+    if (total == null || total <= 0) return null;
+    final ratio = receivedBytes / total;
+    return ratio < 0 ? 0 : (ratio > 1 ? 1 : ratio);
+  }
+
+  @override
+  String toString() =>
+      'ModelDownloadProgress($receivedBytes/${totalBytes ?? '?'} bytes)';
+}
@@ -0,0 +1,214 @@
+import 'dart:convert';
+import 'dart:typed_data';
+
+/// Incremental SHA-256 whose intermediate state can be persisted.
+///
+/// Resumable downloads store [toJson] next to the partial file so a restarted
+/// download continues hashing where it stopped instead of re-reading
+/// gigabytes of already verified data.
+class Sha256Hasher {
+  static const List<int> _initialState = [
+    0x6a09e667,
+    0xbb67ae85,
+    0x3c6ef372,
+    0xa54ff53a,
+    0x510e527f,
+    0x9b05688c,
+    0x1f83d9ab,
+    0x5be0cd19,
+  ];
+
+  // dart format off
+  static const List<int> _k = [
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1,
+    0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+    0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786,
+    0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
+    0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+    0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b,
+    0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a,
+    0x5b9cca4f, 0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+    0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+  ];
+  // dart format on
+
+  final Uint32List _state;
+  final Uint8List _block = Uint8List(64);
+  final Uint32List _words = Uint32List(64);
+  int _blockLength = 0;
+  int _length = 0;
+  String? _digest;
+
+  /// Creates a hasher with an empty input.
+  Sha256Hasher() : _state = Uint32List.fromList(_initialState);
+
+  Sha256Hasher._restored(List<int> state, List<int> block, this._length)
+    : _state = Uint32List.fromList(state) {
+    _block.setAll(0, block);
+    _blockLength = block.length;
+  }
+
+  /// Returns the lowercase hex SHA-256 digest of [bytes].
+  static String digestOf(List<int> bytes) {
+    return (Sha256Hasher()..add(bytes)).close();
+  }
+
+  /// Number of bytes hashed so far.
+  int get length => _length;
+
+  /// Feeds `bytes[start..end)` into the hash.
+  void add(List<int> bytes, [int start = 0, int? end]) {
+    if (_digest != null) {
+      throw StateError('Sha256Hasher is already closed');
+    }
+    final stop = end ?? bytes.length;
+    _length += stop - start;
+    var i = start;
+    if (_blockLength > 0) {
+      while (_blockLength < 64 && i < stop) {
+        _block[_blockLength++] = bytes[i++];
+      }
+      if (_blockLength < 64) return;
+      _compress(_block, 0);
+      _blockLength = 0;
+    }
+    if (bytes is Uint8List) {
+      while (stop - i >= 64) {
+        _compress(bytes, i);
+        i += 64;
+      }
+    } else {
+      while (stop - i >= 64) {
+        _block.setRange(0, 64, bytes, i);
+        _compress(_block, 0);
+        i += 64;
+      }
+    }
+    while (i < stop) {
+      _block[_blockLength++] = bytes[i++];
+    }
+  }
+
+  /// Finishes hashing and returns the lowercase hex digest.
+  ///
+  /// Further calls return the same digest; [add] is no longer allowed.
+  String close() {
+    final existing = _digest;
+    if (existing != null) return existing;
+
+    final bitLengthHigh = (_length ~/ 0x20000000) & 0xffffffff;
+    final bitLengthLow = (_length * 8) & 0xffffffff;
+    _block[_blockLength++] = 0x80;
+    if (_blockLength > 56) {
+      _block.fillRange(_blockLength, 64, 0);
+      _compress(_block, 0);
+      _blockLength = 0;
+    }
+    _block.fillRange(_blockLength, 56, 0);
+    final tail = ByteData.sublistView(_block, 56);
+    tail.setUint32(0, bitLengthHigh);
+    tail.setUint32(4, bitLengthLow);
+    _compress(_block, 0);
+
+    final buffer = StringBuffer();
+    for (final word in _state) {
+      buffer.write(word.toRadixString(16).padLeft(8, '0'));
+    }
+    return _digest = buffer.toString();
+  }
+
+  /// Serializes the intermediate state of an open hasher.
+  Map<String, Object> toJson() {
+    if (_digest != null) {
+      throw StateError('Sha256Hasher is already closed');
+    }
+    return {
+      'state': List<int>.of(_state),
+      'pending': base64.encode(Uint8List.sublistView(_block, 0, _blockLength)),
+      'length': _length,
+    };
+  }
+
+  /// Restores a hasher saved with [toJson], or returns `null` when [json] is
+  /// malformed.
+  static Sha256Hasher? fromJson(Object? json) {
+    if (json is! Map) return null;
+    final state = json['state'];
+    final pending = json['pending'];
+    final length = json['length'];
+    if (state is! List ||
+        state.length != 8 ||
+        state.any((word) => word is! int) ||
+        pending is! String ||
+        length is! int ||
+        length < 0) {
+      return null;
+    }
+    final List<int> block;
+    try {
+      block = base64.decode(pending);
+    } on FormatException {
+      return null;
+    }
+    if (block.length >= 64 || block.length != length % 64) return null;
+    return Sha256Hasher._restored(state.cast<int>(), block, length);
+  }
+
+  void _compress(Uint8List data, int offset) {
+    final w = _words;
+    for (var t = 0; t < 16; t++) {
+      final j = offset + t * 4;
+      w[t] =
+          (data[j] << 24) |
+          (data[j + 1] << 16) |
+          (data[j + 2] << 8) |
+          data[j + 3];
+    }
+    for (var t = 16; t < 64; t++) {
+      final x = w[t - 15];
+      final y = w[t - 2];
+      final s0 = _rotr(x, 7) ^ _rotr(x, 18) ^ (x >> 3);
+      final s1 = _rotr(y, 17) ^ _rotr(y, 19) ^ (y >> 10);
+      w[t] = w[t - 16] + s0 + w[t - 7] + s1;
+    }
+
+    var a = _state[0];
+    var b = _state[1];
+    var c = _state[2];
+    var d = _state[3];
+    var e = _state[4];
+    var f = _state[5];
+    var g = _state[6];
+    var h = _state[7];
+
+    for (var t = 0; t < 64; t++) {
+      final s1 = _rotr(e, 6) ^ _rotr(e, 11) ^ _rotr(e, 25);
+      final ch = (e & f) ^ (~e & 0xffffffff & g);
+      final t1 = (h + s1 + ch + _k[t] + w[t]) & 0xffffffff;
+      final s0 = _rotr(a, 2) ^ _rotr(a, 13) ^ _rotr(a, 22);
+      final maj = (a & b) ^ (a & c) ^ (b & c);
+      final t2 = (s0 + maj) & 0xffffffff;
+      h = g;
+      g = f;
+      f = e;
+      e = (d + t1) & 0xffffffff;
+      d = c;
+      c = b;
+      b = a;
+      a = (t1 + t2) & 0xffffffff;
+    }
+
+    _state[0] += a;
+    _state[1] += b;
+    _state[2] += c;
+    _state[3] += d;
+    _state[4] += e;
+    _state[5] += f;
+    _state[6] += g;
+    _state[7] += h;
+  }
+
+  static int _rotr(int x, int n) => ((x >> n) | (x << (32 - n))) & 0xffffffff;
+}
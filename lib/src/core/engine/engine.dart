@@ -1,17 +1,27 @@
 import 'dart:async';
 import 'dart:convert';
+import 'dart:typed_data';
 import '../../backends/backend.dart';
 import '../template/chat_template_engine.dart';
 import '../exceptions.dart';
+import '../gguf/gguf_model_info.dart';
+import '../quantization/quantization_params.dart';
+import '../quantization/quantization_planner.dart';
+import '../vocab/token_batch.dart';
+import '../vocab/vocab_piece_table.dart';
 import '../models/config/log_level.dart';
+import '../models/config/lora_config.dart';
 import '../models/chat/chat_message.dart';
 import '../models/chat/completion_chunk.dart';
 import '../models/chat/content_part.dart';
 import '../models/chat/chat_template_result.dart';
 import '../llama_logger.dart';
+import 'lora_request_scheduler.dart';
 
 import '../models/inference/model_params.dart';
 import '../models/inference/generation_params.dart';
+import '../models/inference/lora_switch_stats.dart';
+import '../models/inference/prompt_lookup_stats.dart';
 import '../models/inference/tool_choice.dart';
 import '../models/tools/tool_definition.dart';
 
@@ -70,8 +80,11 @@ class LlamaEngine {
   bool _isReady = false;
   String? _modelPath;
   Map<String, String>? _cachedModelMetadata;
+  GgufModelInfo? _modelInfo;
+  Future<VocabPieceTable?>? _pieceTable;
   LlamaLogLevel _dartLogLevel = LlamaLogLevel.none;
   LlamaLogLevel _nativeLogLevel = LlamaLogLevel.none;
+  final LoraRequestScheduler _loraScheduler = LoraRequestScheduler();
 
   /// Configures logging for the library.
   ///
@@ -145,7 +158,13 @@ class LlamaEngine {
       _ensureNotReady();
       _modelPath = path;
       _cachedModelMetadata = null;
+      _pieceTable = null;
+      _modelInfo = null;
       _modelHandle = await backend.modelLoad(path, modelParams);
+      _modelInfo = _loadedModelInfo(_modelHandle!);
+      if (_modelInfo != null) {
+        _cachedModelMetadata = _modelInfo!.toMetadataStrings();
+      }
       _contextHandle = await backend.contextCreate(_modelHandle!, modelParams);
       _isReady = true;
       LlamaLogger.instance.info(
@@ -163,20 +182,40 @@ class LlamaEngine {
 
   /// Loads a model from a [url].
   ///
-  /// This is typically used on the Web platform. Use [ModelParams] to
-  /// configure loading options.
+  /// Web backends stream the model directly. Native backends download it
+  /// into a local cache first (resuming interrupted downloads) and then load
+  /// the cached file; pass [sha256] to verify the download. Use
+  /// [ModelParams] to configure loading options.
   Future<void> loadModelFromUrl(
     String url, {
     ModelParams modelParams = const ModelParams(),
     Function(double progress)? onProgress,
+    String? sha256,
   }) async {
     final modelName = url.split('/').last;
     LlamaLogger.instance.info('Loading model from URL: $modelName');
 
     if (!backend.supportsUrlLoading) {
-      throw UnimplementedError(
-        "loadModelFromUrl for Native should be handled by the caller or a helper.",
-      );
+      final currentBackend = backend;
+      if (currentBackend is! LlamaModelDownloadBackend) {
+        throw UnimplementedError(
+          "loadModelFromUrl for Native should be handled by the caller or a helper.",
+        );
+      }
+      _ensureNotReady();
+      final String localPath;
+      try {
+        localPath = await (currentBackend as LlamaModelDownloadBackend)
+            .downloadModel(url, sha256: sha256, onProgress: onProgress);
+      } catch (e, stackTrace) {
+        LlamaLogger.instance.error(
+          'Failed to download model $modelName from URL $url',
+          e,
+          stackTrace,
+        );
+        throw LlamaModelException("Failed to download model from $url", e);
+      }
+      return loadModel(localPath, modelParams: modelParams);
     }
 
     try {
@@ -184,6 +223,8 @@ class LlamaEngine {
       _ensureNotReady();
       _modelPath = url;
       _cachedModelMetadata = null;
+      _modelInfo = null;
+      _pieceTable = null;
 
       _modelHandle = await backend.modelLoadFromUrl(
         url,
@@ -211,6 +252,8 @@ class LlamaEngine {
       }
       _modelPath = null;
       _cachedModelMetadata = null;
+      _modelInfo = null;
+      _pieceTable = null;
       _isReady = false;
 
       LlamaLogger.instance.error(
@@ -222,6 +265,117 @@ class LlamaEngine {
     }
   }
 
+  /// Reads the header, metadata and tensor table of the GGUF file at [path]
+  /// without loading its weights.
+  ///
+  /// Useful for model catalogs and for checking memory requirements with
+  /// [GgufModelInfo.estimateMemory] before committing to a load. Returns
+  /// `null` when the backend cannot inspect local files (for example on web).
+  Future<GgufModelInfo?> inspectModel(String path) async {
+    final currentBackend = backend;
+    if (currentBackend is! LlamaModelInspectionBackend) return null;
+    try {
+      return await (currentBackend as LlamaModelInspectionBackend)
+          .inspectModel(path);
+    } catch (e) {
+      throw LlamaModelException('Failed to inspect model at $path', e);
+    }
+  }
+
+  /// Quantizes the GGUF model at [inputPath] and writes the result to
+  /// [outputPath].
+  ///
+  /// Runs on the backend without blocking inference. [onProgress] receives
+  /// fractions in `[0.0, 1.0]`; [cancelQuantization] aborts the job.
+  Future<void> quantizeModel(
+    String inputPath,
+    String outputPath,
+    QuantizationParams params, {
+    Function(double progress)? onProgress,
+  }) async {
+    final currentBackend = backend;
+    if (currentBackend is! LlamaQuantizationBackend) {
+      throw LlamaUnsupportedException(
+        'Model quantization is not supported by ${backend.runtimeType}',
+      );
+    }
+    try {
+      await (currentBackend as LlamaQuantizationBackend).quantizeModel(
+        inputPath,
+        outputPath,
+        params,
+        onProgress: onProgress,
+      );
+    } catch (e) {
+      throw LlamaModelException('Failed to quantize model $inputPath', e);
+    }
+  }
+
+  /// Cancels every running [quantizeModel] and [loadModelToFit]
+  /// quantization.
+  void cancelQuantization() {
+    final currentBackend = backend;
+    if (currentBackend is LlamaQuantizationBackend) {
+      (currentBackend as LlamaQuantizationBackend).cancelQuantization();
+    }
+  }
+
+  /// Loads the model at [path], quantizing it first if it does not fit the
+  /// given memory budget.
+  ///
+  /// The fit is estimated from the GGUF tensor table at
+  /// `modelParams.contextSize`. The highest-quality quantization that fits
+  /// is produced once into the backend's cache and reused on later calls.
+  /// Without a [vramBudgetBytes] the model is assumed to run on the CPU and
+  /// only [ramBudgetBytes] is checked. [onProgress] reports quantization
+  /// progress; it is not called when the model already fits.
+  ///
+  /// Backends without on-device quantization load [path] unchanged.
+  Future<void> loadModelToFit(
+    String path, {
+    int? ramBudgetBytes,
+    int? vramBudgetBytes,
+    ModelParams modelParams = const ModelParams(),
+    Function(double progress)? onProgress,
+  }) async {
+    final currentBackend = backend;
+    if (currentBackend is! LlamaQuantizationBackend) {
+      return loadModel(path, modelParams: modelParams);
+    }
+    _ensureNotReady();
+
+    final budget = QuantizationBudget(
+      contextSize: modelParams.contextSize,
+      ramBytes: ramBudgetBytes,
+      vramBytes: vramBudgetBytes,
+      gpuLayers: vramBudgetBytes == null ? 0 : modelParams.gpuLayers,
+    );
+    final String fittedPath;
+    try {
+      fittedPath = await (currentBackend as LlamaQuantizationBackend)
+          .quantizeModelToFit(path, budget, onProgress: onProgress);
+    } catch (e) {
+      throw LlamaModelException('Failed to fit model $path to budget', e);
+    }
+    if (fittedPath != path) {
+      LlamaLogger.instance.info('Using quantized model $fittedPath');
+    }
+    return loadModel(fittedPath, modelParams: modelParams);
+  }
+
+  /// GGUF header, metadata and tensor table of the loaded model, when the
+  /// backend supports inspection.
+  GgufModelInfo? get modelInfo => _modelInfo;
+
+  GgufModelInfo? _loadedModelInfo(int modelHandle) {
+    // The backend parses the header once, while loading the model.
+    final currentBackend = backend;
+    if (currentBackend is! LlamaModelInspectionBackend) return null;
+    return (currentBackend as LlamaModelInspectionBackend).loadedModelInfo(
+      modelHandle,
+    );
+  }
+
   /// Loads a multimodal projector model for vision/audio support.
   Future<void> loadMultimodalProjector(String mmProjPath) async {
     final mmProjName = mmProjPath.split('/').last;
@@ -269,6 +423,8 @@ class LlamaEngine {
     }
     _modelPath = null;
     _cachedModelMetadata = null;
+    _modelInfo = null;
+    _pieceTable = null;
     _isReady = false;
     LlamaLogger.instance.info('Model unloaded.');
   }
@@ -885,6 +1041,11 @@ class LlamaEngine {
   ///
   /// If [parts] contains media content, markers will be automatically injected
   /// into the prompt if missing.
+  ///
+  /// Requests run one at a time and are queued so that requests for the same
+  /// adapter set run back-to-back, minimizing adapter switches. Requests that
+  /// leave [GenerationParams.loras] null form their own set: the adapters
+  /// configured with [setLora].
   Stream<String> generate(
     String prompt, {
     GenerationParams params = const GenerationParams(),
@@ -892,14 +1053,20 @@ class LlamaEngine {
   }) async* {
     _ensureReady();
 
-    final stream = backend.generate(
-      _contextHandle!,
-      prompt,
-      params,
-      parts: parts,
+    final loras = params.loras;
+    final lease = await _loraScheduler.acquire(
+      loras == null
+          ? LoraRequestScheduler.contextDefaultSet
+          : LoraAdapterConfig.setKey(loras),
     );
-
-    yield* stream.transform(const Utf8Decoder(allowMalformed: true));
+    try {
+      _ensureReady();
+      yield* backend
+          .generate(_contextHandle!, prompt, params, parts: parts)
+          .transform(const Utf8Decoder(allowMalformed: true));
+    } finally {
+      lease.release();
+    }
   }
 
   /// Immediately cancels any ongoing generation process.
@@ -918,17 +1085,95 @@ class LlamaEngine {
   }
 
   /// Decodes a list of [tokens] back into a human-readable string.
-  Future<String> detokenize(List<int> tokens, {bool special = false}) {
+  ///
+  /// Uses the model's [VocabPieceTable] when the backend can export one, so
+  /// decoding runs locally without a backend round trip.
+  Future<String> detokenize(List<int> tokens, {bool special = false}) async {
     _ensureReady(requireContext: false);
+    final table = await getVocabPieceTable();
+    if (table != null) {
+      return table.detokenize(tokens, special: special);
+    }
     return backend.detokenize(_modelHandle!, tokens, special: special);
   }
 
+  /// Returns the byte pieces of every token in the loaded model's vocabulary.
+  ///
+  /// The table is fetched once per model and can be used for bulk
+  /// detokenization, for example together with `Utf8Assembler` to turn
+  /// token streams into text piece by piece. Returns `null` when the
+  /// backend cannot export its vocabulary.
+  Future<VocabPieceTable?> getVocabPieceTable() {
+    _ensureReady(requireContext: false);
+    final modelHandle = _modelHandle!;
+    return _pieceTable ??= () async {
+      final currentBackend = backend;
+      if (currentBackend is! LlamaVocabBackend) return null;
+      try {
+        return await (currentBackend as LlamaVocabBackend).vocabPieceTable(
+          modelHandle,
+        );
+      } catch (_) {
+        _pieceTable = null;
+        rethrow;
+      }
+    }();
+  }
+
   /// Utility to count the number of tokens in [text] without running inference.
   Future<int> getTokenCount(String text) async {
     final tokens = await tokenize(text, addSpecial: false);
     return tokens.length;
   }
 
+  /// Encodes every text in [texts] with one backend request.
+  ///
+  /// Backends implementing [LlamaBatchTokenizerBackend] spread large batches
+  /// over up to [threads] tokenizer threads (all CPUs by default); others
+  /// fall back to one [tokenize] call per text.
+  Future<TokenBatch> tokenizeBatch(
+    List<String> texts, {
+    bool addSpecial = true,
+    int? threads,
+  }) async {
+    _ensureReady(requireContext: false);
+    final currentBackend = backend;
+    if (currentBackend is LlamaBatchTokenizerBackend) {
+      return (currentBackend as LlamaBatchTokenizerBackend).tokenizeBatch(
+        _modelHandle!,
+        texts,
+        addSpecial: addSpecial,
+        threads: threads,
+      );
+    }
+    final lists = <List<int>>[];
+    for (final text in texts) {
+      lists.add(await tokenize(text, addSpecial: addSpecial));
+    }
+    return TokenBatch.fromLists(lists);
+  }
+
+  /// Counts the tokens of every text in [texts], like [getTokenCount].
+  ///
+  /// See [tokenizeBatch] for how the work is spread.
+  Future<Int32List> countTokensBatch(List<String> texts, {int? threads}) async {
+    _ensureReady(requireContext: false);
+    final currentBackend = backend;
+    if (currentBackend is LlamaBatchTokenizerBackend) {
+      return (currentBackend as LlamaBatchTokenizerBackend).countTokensBatch(
+        _modelHandle!,
+        texts,
+        addSpecial: false,
+        threads: threads,
+      );
+    }
+    final counts = Int32List(texts.length);
+    for (var i = 0; i < texts.length; i++) {
+      counts[i] = await getTokenCount(texts[i]);
+    }
+    return counts;
+  }
+
   // ============================================================
   // MODEL INTROSPECTION
   // ============================================================
@@ -992,6 +1237,32 @@ class LlamaEngine {
     return backend.clearLoraAdapters(_contextHandle!);
   }
 
+  /// Returns adapter switching statistics for the current context.
+  ///
+  /// Returns `null` when the backend does not report them.
+  Future<LoraSwitchStats?> getLoraSwitchStats() async {
+    _ensureReady();
+    final currentBackend = backend;
+    if (currentBackend is! LlamaLoraStatsBackend) return null;
+    return (currentBackend as LlamaLoraStatsBackend).loraSwitchStats(
+      _contextHandle!,
+    );
+  }
+
+  /// Returns prompt-lookup decoding statistics for the current context.
+  ///
+  /// Counters cover requests that set
+  /// [GenerationParams.promptLookupDraftTokens]. Returns `null` when the
+  /// backend does not support prompt-lookup decoding.
+  Future<PromptLookupStats?> getPromptLookupStats() async {
+    _ensureReady();
+    final currentBackend = backend;
+    if (currentBackend is! LlamaPromptLookupBackend) return null;
+    return (currentBackend as LlamaPromptLookupBackend).promptLookupStats(
+      _contextHandle!,
+    );
+  }
+
   // ============================================================
   // BACKEND UTILITIES
   // ============================================================
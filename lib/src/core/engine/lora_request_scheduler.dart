@@ -0,0 +1,93 @@
+import 'dart:async';
+
+/// Orders generation requests on a shared context by LoRA adapter set.
+///
+/// Runs one request at a time on the shared context. When the running request
+/// finishes, queued requests for the adapter set that is already applied go
+/// first, so a burst of mixed tenants causes as few adapter switches as
+/// possible. [maxConsecutive] bounds how many same-set requests may overtake
+/// an older request for a different set, keeping other tenants from starving.
+class LoraRequestScheduler {
+  /// Maximum number of back-to-back grants for one adapter set while requests
+  /// for other sets are waiting.
+  final int maxConsecutive;
+
+  /// Adapter set key for requests that run with the context's configured
+  /// adapters. Keys from `LoraAdapterConfig.setKey` are empty or contain `=`,
+  /// so this never collides with an explicit set.
+  static const String contextDefaultSet = '<context>';
+
+  final List<_PendingLoraRequest> _queue = [];
+  String? _activeAdapterSet;
+  bool _running = false;
+  int _streak = 0;
+
+  /// Creates a scheduler.
+  LoraRequestScheduler({this.maxConsecutive = 8})
+    : assert(maxConsecutive > 0, 'maxConsecutive must be positive');
+
+  /// Adapter set key of the most recently granted request.
+  String? get activeAdapterSet => _activeAdapterSet;
+
+  /// Number of requests waiting for their turn.
+  int get pendingCount => _queue.length;
+
+  /// Waits until a request for [adapterSet] may run.
+  ///
+  /// The returned lease must be released once the request completes.
+  Future<LoraSchedulerLease> acquire(String adapterSet) {
+    if (!_running && _queue.isEmpty) {
+      _grant(adapterSet);
+      return Future.value(LoraSchedulerLease._(this));
+    }
+    final pending = _PendingLoraRequest(adapterSet);
+    _queue.add(pending);
+    return pending.completer.future;
+  }
+
+  void _grant(String adapterSet) {
+    _running = true;
+    _streak = adapterSet == _activeAdapterSet ? _streak + 1 : 1;
+    _activeAdapterSet = adapterSet;
+  }
+
+  void _release() {
+    _running = false;
+    if (_queue.isEmpty) return;
+
+    var index = 0;
+    if (_streak < maxConsecutive) {
+      final sameSet = _queue.indexWhere(
+        (pending) => pending.adapterSet == _activeAdapterSet,
+      );
+      if (sameSet >= 0) index = sameSet;
+    }
+
+    final next = _queue.removeAt(index);
+    _grant(next.adapterSet);
+    next.completer.complete(LoraSchedulerLease._(this));
+  }
+}
+
+/// Permission to run one request granted by a [LoraRequestScheduler].
+class LoraSchedulerLease {
+  final LoraRequestScheduler _scheduler;
+  bool _released = false;
+
+  LoraSchedulerLease._(this._scheduler);
+
+  /// Hands the context to the next queued request. Safe to call twice.
+  void release() {
+    if (_released) return;
+    _released = true;
+    _scheduler._release();
+  }
+}
+
+class _PendingLoraRequest {
+  final String adapterSet;
+  final Completer<LoraSchedulerLease> completer =
+      Completer<LoraSchedulerLease>();
+
+  _PendingLoraRequest(this.adapterSet);
+}
@@ -0,0 +1,304 @@
+import 'gguf_reader.dart';
+
+/// Tensor count, parameters and bytes stored with one ggml type.
+class GgufQuantizationShare {
+  /// ggml type name, for example `Q4_K`.
+  final String typeName;
+
+  /// Number of tensors stored with this type.
+  final int tensorCount;
+
+  /// Number of parameters stored with this type.
+  final int parameterCount;
+
+  /// Bytes of tensor data stored with this type.
+  final int byteSize;
+
+  /// Creates a quantization share entry.
+  const GgufQuantizationShare({
+    required this.typeName,
+    required this.tensorCount,
+    required this.parameterCount,
+    required this.byteSize,
+  });
+}
+
+/// Approximate memory needed to run a model at a given context size.
+class GgufMemoryEstimate {
+  /// Context size the estimate was computed for.
+  final int contextSize;
+
+  /// Bytes of model weights.
+  final int weightsBytes;
+
+  /// Bytes of the KV cache.
+  final int kvCacheBytes;
+
+  /// Bytes of scratch buffers used while evaluating a batch.
+  final int computeBytes;
+
+  /// Part of the total expected in host memory.
+  final int ramBytes;
+
+  /// Part of the total expected in GPU memory.
+  final int vramBytes;
+
+  /// Creates a memory estimate.
+  const GgufMemoryEstimate({
+    required this.contextSize,
+    required this.weightsBytes,
+    required this.kvCacheBytes,
+    required this.computeBytes,
+    required this.ramBytes,
+    required this.vramBytes,
+  });
+
+  /// Total estimated bytes across host and GPU memory.
+  int get totalBytes => ramBytes + vramBytes;
+}
+
+/// Header, metadata and tensor table of a GGUF file.
+///
+/// Produced by [GgufReader] without loading weights, so it is cheap enough to
+/// build for every file in a model catalog.
+class GgufModelInfo {
+  /// GGUF format version.
+  final int version;
+
+  /// Raw metadata values keyed by GGUF key.
+  ///
+  /// Scalars are `int`, `double`, `bool` or `String`; uint64 values that do
+  /// not fit a signed 64-bit `int` are `BigInt`. Arrays are `List`s, or
+  /// [GgufArrayInfo] when too large to materialize.
+  final Map<String, Object?> metadata;
+
+  /// Tensor table in file order.
+  final List<GgufTensorInfo> tensors;
+
+  /// Absolute file offset where tensor data begins.
+  final int dataOffset;
+
+  /// Size of the inspected file in bytes.
+  final int fileSize;
+
+  /// Creates model info from parsed GGUF structures.
+  const GgufModelInfo({
+    required this.version,
+    required this.metadata,
+    required this.tensors,
+    required this.dataOffset,
+    required this.fileSize,
+  });
+
+  /// Model architecture (`general.architecture`), for example `llama`.
+  String? get architecture => _string('general.architecture');
+
+  /// Human-readable model name (`general.name`).
+  String? get name => _string('general.name');
+
+  /// Training context length.
+  int? get contextLength => _archInt('context_length');
+
+  /// Number of repeating transformer blocks.
+  int? get blockCount => _archInt('block_count');
+
+  /// Embedding width.
+  int? get embeddingLength => _archInt('embedding_length');
+
+  /// Feed-forward width.
+  int? get feedForwardLength => _archInt('feed_forward_length');
+
+  /// Number of attention heads.
+  int? get headCount => _archInt('attention.head_count');
+
+  /// Number of key/value heads (grouped-query attention).
+  int? get headCountKv => _archInt('attention.head_count_kv') ?? headCount;
+
+  /// Default Jinja chat template (`tokenizer.chat_template`).
+  String? get chatTemplate => _string('tokenizer.chat_template');
+
+  /// Vocabulary size, when recorded.
+  int? get vocabularySize {
+    final tokens = metadata['tokenizer.ggml.tokens'];
+    if (tokens is GgufArrayInfo) return tokens.length;
+    if (tokens is List) return tokens.length;
+    return _archInt('vocab_size');
+  }
+
+  /// `llama_ftype` recorded in `general.file_type`.
+  int? get fileType {
+    final value = metadata['general.file_type'];
+    return value is int ? value : null;
+  }
+
+  /// Name of [fileType] as used in llama.cpp file names (for example
+  /// `Q4_K_M`), or `null` when unknown.
+  String? get fileTypeName {
+    final type = fileType;
+    return type == null ? null : _fileTypeNames[type];
+  }
+
+  /// Total bytes of tensor data.
+  int get tensorBytes => tensors.fold(0, (sum, t) => sum + t.byteSize);
+
+  /// Total number of parameters.
+  int get parameterCount => tensors.fold(0, (sum, t) => sum + t.elementCount);
+
+  /// Whether every tensor's data lies within the file.
+  ///
+  /// `false` usually means a truncated download.
+  bool get isComplete {
+    for (final tensor in tensors) {
+      if (dataOffset + tensor.offset + tensor.byteSize > fileSize) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /// Tensor storage grouped by ggml type, largest share first.
+  List<GgufQuantizationShare> get quantizationMix {
+    final counts = <String, List<int>>{};
+    for (final tensor in tensors) {
+      final entry = counts.putIfAbsent(tensor.typeName, () => [0, 0, 0]);
+      entry[0] += 1;
+      entry[1] += tensor.elementCount;
+      entry[2] += tensor.byteSize;
+    }
+    final shares = [
+      for (final MapEntry(:key, :value) in counts.entries)
+        GgufQuantizationShare(
+          typeName: key,
+          tensorCount: value[0],
+          parameterCount: value[1],
+          byteSize: value[2],
+        ),
+    ]..sort((a, b) => b.byteSize.compareTo(a.byteSize));
+    return shares;
+  }
+
+  /// Metadata formatted the way llama.cpp reports it through
+  /// `llama_model_meta_val_str`: scalars only, arrays omitted, floats with
+  /// six decimals.
+  Map<String, String> toMetadataStrings() {
+    final result = <String, String>{};
+    metadata.forEach((key, value) {
+      if (value == null || value is List || value is GgufArrayInfo) return;
+      result[key] = value is double ? value.toStringAsFixed(6) : '$value';
+    });
+    return result;
+  }
+
+  /// Estimates memory needed at [contextSize] tokens.
+  ///
+  /// [gpuLayers] follows `ModelParams.gpuLayers`: the last layers are
+  /// offloaded first and the output layer moves to the GPU once every block
+  /// is offloaded. [batchSize] is the evaluation batch used to size scratch
+  /// buffers, and [kvBytesPerElement] is 2 for the default f16 KV cache.
+  ///
+  /// The estimate ignores sliding-window and recurrent-state savings, so it
+  /// errs on the high side for such architectures.
+  GgufMemoryEstimate estimateMemory({
+    required int contextSize,
+    int gpuLayers = 0,
+    int batchSize = 512,
+    int kvBytesPerElement = 2,
+  }) {
+    final layers = blockCount ?? 0;
+    final firstGpuLayer = layers - gpuLayers < 0 ? 0 : layers - gpuLayers;
+    final outputOnGpu = gpuLayers > layers;
+
+    var ramWeights = 0;
+    var vramWeights = 0;
+    for (final tensor in tensors) {
+      final block = tensor.blockIndex;
+      final onGpu = block != null
+          ? block >= firstGpuLayer
+          : outputOnGpu && !tensor.name.startsWith('token_embd');
+      if (onGpu) {
+        vramWeights += tensor.byteSize;
+      } else {
+        ramWeights += tensor.byteSize;
+      }
+    }
+
+    final embd = embeddingLength ?? 0;
+    final heads = headCount ?? 1;
+    final kvHeads = headCountKv ?? heads;
+    final headDim = heads > 0 ? embd ~/ heads : 0;
+    final keyLength = _archInt('attention.key_length') ?? headDim;
+    final valueLength = _archInt('attention.value_length') ?? headDim;
+    final kvPerLayer =
+        contextSize * kvHeads * (keyLength + valueLength) * kvBytesPerElement;
+    final gpuKvLayers = layers - firstGpuLayer;
+    final vramKv = kvPerLayer * gpuKvLayers;
+    final ramKv = kvPerLayer * (layers - gpuKvLayers);
+
+    final ffn = feedForwardLength ?? embd * 4;
+    final batch = batchSize < contextSize ? batchSize : contextSize;
+    final compute = batch * ((vocabularySize ?? 0) + embd * 4 + ffn * 2) * 4;
+
+    return GgufMemoryEstimate(
+      contextSize: contextSize,
+      weightsBytes: ramWeights + vramWeights,
+      kvCacheBytes: ramKv + vramKv,
+      computeBytes: compute,
+      ramBytes: ramWeights + ramKv + (gpuLayers > 0 ? 0 : compute),
+      vramBytes: vramWeights + vramKv + (gpuLayers > 0 ? compute : 0),
+    );
+  }
+
+  String? _string(String key) {
+    final value = metadata[key];
+    return value is String ? value : null;
+  }
+
+  int? _archInt(String suffix) {
+    final arch = architecture;
+    if (arch == null) return null;
+    final value = metadata['$arch.$suffix'];
+    if (value is int) return value;
+    if (value is List && value.isNotEmpty) {
+      // Per-layer values (for example head_count_kv on hybrid models); use
+      // the largest so estimates stay conservative.
+      return value.whereType<int>().fold<int>(0, (a, b) => a > b ? a : b);
+    }
+    return null;
+  }
+
+  static const Map<int, String> _fileTypeNames = {
+    0: 'F32',
+    1: 'F16',
+    2: 'Q4_0',
+    3: 'Q4_1',
+    7: 'Q8_0',
+    8: 'Q5_0',
+    9: 'Q5_1',
+    10: 'Q2_K',
+    11: 'Q3_K_S',
+    12: 'Q3_K_M',
+    13: 'Q3_K_L',
+    14: 'Q4_K_S',
+    15: 'Q4_K_M',
+    16: 'Q5_K_S',
+    17: 'Q5_K_M',
+    18: 'Q6_K',
+    19: 'IQ2_XXS',
+    20: 'IQ2_XS',
+    21: 'Q2_K_S',
+    22: 'IQ3_XS',
+    23: 'IQ3_XXS',
+    24: 'IQ1_S',
+    25: 'IQ4_NL',
+    26: 'IQ3_S',
+    27: 'IQ3_M',
+    28: 'IQ2_S',
+    29: 'IQ2_M',
+    30: 'IQ4_XS',
+    31: 'IQ1_M',
+    32: 'BF16',
+    36: 'TQ1_0',
+    37: 'TQ2_0',
+    38: 'MXFP4_MOE',
+  };
+}
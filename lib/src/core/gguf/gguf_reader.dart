@@ -0,0 +1,488 @@
+import 'dart:convert';
+import 'dart:typed_data';
+
+import 'gguf_model_info.dart';
+
+/// Random-access view over the bytes of a GGUF file.
+///
+/// Implementations only need to serve the ranges the parser asks for, so a
+/// file-backed source never has to read tensor data.
+abstract class GgufByteSource {
+  /// Total size of the underlying file in bytes.
+  int get length;
+
+  /// Returns up to [length] bytes starting at [offset].
+  ///
+  /// May return fewer bytes only at the end of the source.
+  Uint8List read(int offset, int length);
+}
+
+/// [GgufByteSource] over bytes already in memory.
+class GgufBytesSource implements GgufByteSource {
+  final Uint8List _bytes;
+
+  /// Creates a source over [bytes] without copying them.
+  GgufBytesSource(this._bytes);
+
+  @override
+  int get length => _bytes.length;
+
+  @override
+  Uint8List read(int offset, int length) {
+    final start = offset.clamp(0, _bytes.length).toInt();
+    final end = (offset + length).clamp(start, _bytes.length).toInt();
+    return Uint8List.sublistView(_bytes, start, end);
+  }
+}
+
+/// GGUF metadata value types.
+enum GgufValueType {
+  /// 8-bit unsigned integer.
+  uint8(0, 1),
+
+  /// 8-bit signed integer.
+  int8(1, 1),
+
+  /// 16-bit unsigned integer.
+  uint16(2, 2),
+
+  /// 16-bit signed integer.
+  int16(3, 2),
+
+  /// 32-bit unsigned integer.
+  uint32(4, 4),
+
+  /// 32-bit signed integer.
+  int32(5, 4),
+
+  /// 32-bit float.
+  float32(6, 4),
+
+  /// Boolean stored in one byte.
+  boolean(7, 1),
+
+  /// Length-prefixed UTF-8 string.
+  string(8, 0),
+
+  /// Typed array.
+  array(9, 0),
+
+  /// 64-bit unsigned integer.
+  uint64(10, 8),
+
+  /// 64-bit signed integer.
+  int64(11, 8),
+
+  /// 64-bit float.
+  float64(12, 8);
+
+  /// Wire id of the type.
+  final int id;
+
+  /// Fixed encoded size in bytes, or 0 for variable-size types.
+  final int size;
+
+  const GgufValueType(this.id, this.size);
+
+  /// Returns the type for wire [id].
+  static GgufValueType fromId(int id) {
+    for (final type in values) {
+      if (type.id == id) return type;
+    }
+    throw FormatException('Unknown GGUF value type: $id');
+  }
+}
+
+/// A GGUF array value that was not materialized.
+///
+/// Large arrays such as tokenizer vocabularies are skipped during parsing;
+/// only their element type and length are kept.
+class GgufArrayInfo {
+  /// Element type.
+  final GgufValueType elementType;
+
+  /// Number of elements.
+  final int length;
+
+  /// Creates an array descriptor.
+  const GgufArrayInfo(this.elementType, this.length);
+
+  @override
+  String toString() => 'GgufArrayInfo(${elementType.name}, $length)';
+}
+
+/// Block layout of a ggml tensor type.
+class GgmlTypeInfo {
+  /// ggml type name as printed by llama.cpp (for example `Q4_K`).
+  final String name;
+
+  /// Number of elements per block.
+  final int blockSize;
+
+  /// Bytes per block.
+  final int typeSize;
+
+  /// Creates a type descriptor.
+  const GgmlTypeInfo(this.name, this.blockSize, this.typeSize);
+
+  /// Known ggml tensor types keyed by `ggml_type` id.
+  static const Map<int, GgmlTypeInfo> known = {
+    0: GgmlTypeInfo('F32', 1, 4),
+    1: GgmlTypeInfo('F16', 1, 2),
+    2: GgmlTypeInfo('Q4_0', 32, 18),
+    3: GgmlTypeInfo('Q4_1', 32, 20),
+    6: GgmlTypeInfo('Q5_0', 32, 22),
+    7: GgmlTypeInfo('Q5_1', 32, 24),
+    8: GgmlTypeInfo('Q8_0', 32, 34),
+    9: GgmlTypeInfo('Q8_1', 32, 36),
+    10: GgmlTypeInfo('Q2_K', 256, 84),
+    11: GgmlTypeInfo('Q3_K', 256, 110),
+    12: GgmlTypeInfo('Q4_K', 256, 144),
+    13: GgmlTypeInfo('Q5_K', 256, 176),
+    14: GgmlTypeInfo('Q6_K', 256, 210),
+    15: GgmlTypeInfo('Q8_K', 256, 292),
+    16: GgmlTypeInfo('IQ2_XXS', 256, 66),
+    17: GgmlTypeInfo('IQ2_XS', 256, 74),
+    18: GgmlTypeInfo('IQ3_XXS', 256, 98),
+    19: GgmlTypeInfo('IQ1_S', 256, 50),
+    20: GgmlTypeInfo('IQ4_NL', 32, 18),
+    21: GgmlTypeInfo('IQ3_S', 256, 110),
+    22: GgmlTypeInfo('IQ2_S', 256, 82),
+    23: GgmlTypeInfo('IQ4_XS', 256, 136),
+    24: GgmlTypeInfo('I8', 1, 1),
+    25: GgmlTypeInfo('I16', 1, 2),
+    26: GgmlTypeInfo('I32', 1, 4),
+    27: GgmlTypeInfo('I64', 1, 8),
+    28: GgmlTypeInfo('F64', 1, 8),
+    29: GgmlTypeInfo('IQ1_M', 256, 56),
+    30: GgmlTypeInfo('BF16', 1, 2),
+    34: GgmlTypeInfo('TQ1_0', 256, 54),
+    35: GgmlTypeInfo('TQ2_0', 256, 66),
+    39: GgmlTypeInfo('MXFP4', 32, 17),
+  };
+}
+
+/// One entry of the GGUF tensor table.
+class GgufTensorInfo {
+  /// Tensor name, for example `blk.0.attn_q.weight`.
+  final String name;
+
+  /// Dimensions, innermost first.
+  final List<int> shape;
+
+  /// `ggml_type` id of the stored data.
+  final int type;
+
+  /// Offset of the tensor data relative to the start of the data section.
+  final int offset;
+
+  /// Size of the tensor data in bytes.
+  final int byteSize;
+
+  /// Creates a tensor table entry.
+  const GgufTensorInfo({
+    required this.name,
+    required this.shape,
+    required this.type,
+    required this.offset,
+    required this.byteSize,
+  });
+
+  /// Number of elements.
+  int get elementCount => shape.fold(1, (count, dim) => count * dim);
+
+  /// ggml type name, or `TYPE_<id>` for types unknown to this reader.
+  String get typeName => GgmlTypeInfo.known[type]?.name ?? 'TYPE_$type';
+
+  /// Transformer block index parsed from `blk.<n>.` names, or `null` for
+  /// tensors outside the repeating layers.
+  int? get blockIndex {
+    if (!name.startsWith('blk.')) return null;
+    final end = name.indexOf('.', 4);
+    if (end < 0) return null;
+    return int.tryParse(name.substring(4, end));
+  }
+}
+
+/// Parses GGUF headers, metadata and tensor tables without reading weights.
+class GgufReader {
+  /// Arrays longer than this are recorded as [GgufArrayInfo] instead of
+  /// being decoded.
+  static const int maxMaterializedArrayLength = 1024;
+
+  static const int _magic = 0x46554747; // "GGUF" little-endian
+  static const int _defaultAlignment = 32;
+  static const int _windowSize = 1 << 20;
+
+  final GgufByteSource _source;
+  Endian _endian = Endian.little;
+  Uint8List _window = Uint8List(0);
+  ByteData _windowData = ByteData(0);
+  int _windowStart = 0;
+  int _position = 0;
+
+  GgufReader._(this._source);
+
+  /// Parses the GGUF structure exposed by [source].
+  ///
+  /// Throws a [FormatException] when the bytes are not a supported GGUF file.
+  static GgufModelInfo parse(GgufByteSource source) {
+    return GgufReader._(source)._parse();
+  }
+
+  /// Parses an in-memory GGUF file.
+  static GgufModelInfo parseBytes(Uint8List bytes) {
+    return parse(GgufBytesSource(bytes));
+  }
+
+  GgufModelInfo _parse() {
+    if (_source.length < 24) {
+      throw const FormatException('File too small to be GGUF');
+    }
+    if (_readUint32() != _magic) {
+      throw const FormatException('Missing GGUF magic');
+    }
+
+    var version = _readUint32();
+    if (version > 0xffff) {
+      // Big-endian files store the version byte-swapped.
+      _endian = Endian.big;
+      version = _swap32(version);
+    }
+    if (version < 2) {
+      throw FormatException('Unsupported GGUF version: $version');
+    }
+
+    final tensorCount = _readUint64();
+    final kvCount = _readUint64();
+    if (tensorCount < 0 || kvCount < 0) {
+      throw const FormatException('Corrupt GGUF header counts');
+    }
+
+    final metadata = <String, Object?>{};
+    for (var i = 0; i < kvCount; i++) {
+      final key = _readString();
+      final type = GgufValueType.fromId(_readUint32());
+      metadata[key] = _readValue(type);
+    }
+
+    final rawTensors = <_RawTensor>[];
+    for (var i = 0; i < tensorCount; i++) {
+      final name = _readString();
+      final nDims = _readUint32();
+      if (nDims > 8) {
+        throw FormatException('Tensor $name has $nDims dimensions');
+      }
+      final shape = List<int>.generate(nDims, (_) => _readUint64());
+      final type = _readUint32();
+      final offset = _readUint64();
+      rawTensors.add(_RawTensor(name, shape, type, offset));
+    }
+
+    final alignmentValue = metadata['general.alignment'];
+    final alignment = alignmentValue is int && alignmentValue > 0
+        ? alignmentValue
+        : _defaultAlignment;
+    final dataOffset = _alignUp(_position, alignment);
+
+    return GgufModelInfo(
+      version: version,
+      metadata: metadata,
+      tensors: _resolveTensorSizes(rawTensors, dataOffset),
+      dataOffset: dataOffset,
+      fileSize: _source.length,
+    );
+  }
+
+  List<GgufTensorInfo> _resolveTensorSizes(
+    List<_RawTensor> raw,
+    int dataOffset,
+  ) {
+    // Types unknown to this reader are sized from the gap to the next tensor.
+    final byOffset = raw.toList()..sort((a, b) => a.offset.compareTo(b.offset));
+    final nextOffset = <_RawTensor, int>{};
+    for (var i = 0; i < byOffset.length; i++) {
+      nextOffset[byOffset[i]] = i + 1 < byOffset.length
+          ? byOffset[i + 1].offset
+          : _source.length - dataOffset;
+    }
+
+    return [
+      for (final tensor in raw)
+        GgufTensorInfo(
+          name: tensor.name,
+          shape: List<int>.unmodifiable(tensor.shape),
+          type: tensor.type,
+          offset: tensor.offset,
+          byteSize: _tensorBytes(tensor) ?? nextOffset[tensor]! - tensor.offset,
+        ),
+    ];
+  }
+
+  static int? _tensorBytes(_RawTensor tensor) {
+    final info = GgmlTypeInfo.known[tensor.type];
+    if (info == null || tensor.shape.isEmpty) return null;
+    final rowElements = tensor.shape.first;
+    var rows = 1;
+    for (var i = 1; i < tensor.shape.length; i++) {
+      rows *= tensor.shape[i];
+    }
+    return rows * (rowElements ~/ info.blockSize) * info.typeSize;
+  }
+
+  Object? _readValue(GgufValueType type) {
+    switch (type) {
+      case GgufValueType.uint8:
+        return _take(1).getUint8(_offsetInWindow(1));
+      case GgufValueType.int8:
+        return _take(1).getInt8(_offsetInWindow(1));
+      case GgufValueType.uint16:
+        return _take(2).getUint16(_offsetInWindow(2), _endian);
+      case GgufValueType.int16:
+        return _take(2).getInt16(_offsetInWindow(2), _endian);
+      case GgufValueType.uint32:
+        return _readUint32();
+      case GgufValueType.int32:
+        return _take(4).getInt32(_offsetInWindow(4), _endian);
+      case GgufValueType.float32:
+        return _take(4).getFloat32(_offsetInWindow(4), _endian);
+      case GgufValueType.boolean:
+        return _take(1).getUint8(_offsetInWindow(1)) != 0;
+      case GgufValueType.string:
+        return _readString();
+      case GgufValueType.array:
+        return _readArray();
+      case GgufValueType.uint64:
+        return _readUint64Value();
+      case GgufValueType.int64:
+        return _readInt64();
+      case GgufValueType.float64:
+        return _take(8).getFloat64(_offsetInWindow(8), _endian);
+    }
+  }
+
+  Object _readArray() {
+    final elementType = GgufValueType.fromId(_readUint32());
+    final length = _readUint64();
+    if (length < 0) {
+      throw const FormatException('Corrupt GGUF array length');
+    }
+    if (elementType == GgufValueType.array) {
+      throw const FormatException('Nested GGUF arrays are not supported');
+    }
+
+    if (length > maxMaterializedArrayLength) {
+      if (elementType == GgufValueType.string) {
+        for (var i = 0; i < length; i++) {
+          _skip(_readUint64());
+        }
+      } else {
+        _skip(length * elementType.size);
+      }
+      return GgufArrayInfo(elementType, length);
+    }
+
+    return List<Object?>.generate(
+      length,
+      (_) => _readValue(elementType),
+      growable: false,
+    );
+  }
+
+  String _readString() {
+    final length = _readUint64();
+    if (length < 0 || _position + length > _source.length) {
+      throw const FormatException('GGUF string exceeds file bounds');
+    }
+    _take(length);
+    final start = _offsetInWindow(length);
+    return utf8.decode(
+      Uint8List.sublistView(_window, start, start + length),
+      allowMalformed: true,
+    );
+  }
+
+  int _readUint32() => _take(4).getUint32(_offsetInWindow(4), _endian);
+
+  // 64-bit values are assembled from two 32-bit halves because
+  // ByteData.getInt64 is unavailable when compiled to JavaScript.
+  int _readUint64() {
+    final (:high, :low) = _readHalves();
+    if (high >= 0x80000000) {
+      throw const FormatException('GGUF 64-bit value out of range');
+    }
+    return high * 0x100000000 + low;
+  }
+
+  /// Reads a uint64 metadata value, as a [BigInt] when it does not fit a
+  /// signed 64-bit int. Only sizes and offsets must be in range.
+  Object _readUint64Value() {
+    final (:high, :low) = _readHalves();
+    if (high >= 0x80000000) {
+      return (BigInt.from(high) << 32) | BigInt.from(low);
+    }
+    return high * 0x100000000 + low;
+  }
+
+  int _readInt64() {
+    final (:high, :low) = _readHalves();
+    final signedHigh = high >= 0x80000000 ? high - 0x100000000 : high;
+    return signedHigh * 0x100000000 + low;
+  }
+
+  ({int high, int low}) _readHalves() {
+    final data = _take(8);
+    final offset = _offsetInWindow(8);
+    final little = _endian == Endian.little;
+    return (
+      high: data.getUint32(offset + (little ? 4 : 0), _endian),
+      low: data.getUint32(offset + (little ? 0 : 4), _endian),
+    );
+  }
+
+  /// Ensures [count] bytes at the cursor are in the window and advances.
+  ByteData _take(int count) {
+    if (_position < _windowStart ||
+        _position + count > _windowStart + _window.length) {
+      final size = count > _windowSize ? count : _windowSize;
+      _window = _source.read(_position, size);
+      _windowData = ByteData.sublistView(_window);
+      _windowStart = _position;
+      if (_window.length < count) {
+        throw const FormatException('Unexpected end of GGUF file');
+      }
+    }
+    _position += count;
+    return _windowData;
+  }
+
+  /// Offset within the window of the value [_take] just consumed.
+  int _offsetInWindow(int count) => _position - count - _windowStart;
+
+  void _skip(int count) {
+    if (count < 0 || _position + count > _source.length) {
+      throw const FormatException('GGUF value exceeds file bounds');
+    }
+    _position += count;
+  }
+
+  static int _alignUp(int value, int alignment) {
+    return (value + alignment - 1) ~/ alignment * alignment;
+  }
+
+  static int _swap32(int value) {
+    return ((value & 0xff) << 24) |
+        ((value & 0xff00) << 8) |
+        ((value >> 8) & 0xff00) |
+        ((value >> 24) & 0xff);
+  }
+}
+
+class _RawTensor {
+  final String name;
+  final List<int> shape;
+  final int type;
+  final int offset;
+
+  const _RawTensor(this.name, this.shape, this.type, this.offset);
+}
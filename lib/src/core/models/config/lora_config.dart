@@ -8,4 +8,18 @@ class LoraAdapterConfig {
 
   /// Creates a LoRA adapter configuration.
   const LoraAdapterConfig({required this.path, this.scale = 1.0});
+
+  /// Returns a canonical key identifying the adapter set [adapters].
+  ///
+  /// The key is independent of list order. When a path appears more than
+  /// once the last scale wins, matching how adapters are applied. An empty
+  /// set yields an empty key (the base model).
+  static String setKey(Iterable<LoraAdapterConfig> adapters) {
+    final scales = <String, double>{};
+    for (final adapter in adapters) {
+      scales[adapter.path] = adapter.scale;
+    }
+    final paths = scales.keys.toList()..sort();
+    return paths.map((path) => '$path=${scales[path]}').join('|');
+  }
 }
@@ -0,0 +1,90 @@
+/// NUMA placement strategy for native CPU inference threads.
+///
+/// Mirrors llama.cpp's `ggml_numa_strategy`. The strategy is applied once per
+/// process, on the first model load that requests it.
+enum NumaStrategy {
+  /// No NUMA-specific placement (default).
+  disabled,
+
+  /// Spread threads evenly across NUMA nodes.
+  distribute,
+
+  /// Keep threads on the node the process started on.
+  isolate,
+
+  /// Use the CPU map provided by `numactl`.
+  numactl,
+
+  /// Mirror model weights across nodes where supported.
+  mirror,
+}
+
+/// CPU threading configuration for native inference.
+///
+/// Only native backends honor these settings; they are ignored on web.
+class ThreadingConfig {
+  /// Runs a short calibration decode when a context is created and picks the
+  /// fastest thread counts for prompt prefill and token decode separately.
+  ///
+  /// Only phases left at 0 in `ModelParams.numberOfThreads` /
+  /// `numberOfThreadsBatch` are tuned. Results are cached per host, model
+  /// and quantization, so calibration runs once per combination.
+  final bool autotune;
+
+  /// Attaches persistent ggml threadpools to the context, one sized for
+  /// decode and one for prefill, so worker threads are not spun up per call.
+  final bool persistentThreadpool;
+
+  /// CPU indices the threadpool workers may run on. Empty allows any CPU.
+  final List<int> cpuAffinity;
+
+  /// Pins each threadpool worker to a single CPU from [cpuAffinity] instead
+  /// of letting it float within the set.
+  final bool strictCpuPlacement;
+
+  /// How aggressively idle threadpool workers busy-poll for new work
+  /// (0 = sleep immediately, 100 = spin longest).
+  final int pollLevel;
+
+  /// NUMA placement strategy.
+  final NumaStrategy numa;
+
+  /// Directory for the thread tuning cache. Defaults to the platform cache
+  /// directory.
+  final String? tuningCacheDirectory;
+
+  /// Default threadpool busy-poll level, matching llama.cpp.
+  static const int defaultPollLevel = 50;
+
+  /// Creates a threading configuration.
+  const ThreadingConfig({
+    this.autotune = false,
+    this.persistentThreadpool = false,
+    this.cpuAffinity = const [],
+    this.strictCpuPlacement = false,
+    this.pollLevel = defaultPollLevel,
+    this.numa = NumaStrategy.disabled,
+    this.tuningCacheDirectory,
+  });
+
+  /// Creates a copy of this [ThreadingConfig] with updated fields.
+  ThreadingConfig copyWith({
+    bool? autotune,
+    bool? persistentThreadpool,
+    List<int>? cpuAffinity,
+    bool? strictCpuPlacement,
+    int? pollLevel,
+    NumaStrategy? numa,
+    String? tuningCacheDirectory,
+  }) {
+    return ThreadingConfig(
+      autotune: autotune ?? this.autotune,
+      persistentThreadpool: persistentThreadpool ?? this.persistentThreadpool,
+      cpuAffinity: cpuAffinity ?? this.cpuAffinity,
+      strictCpuPlacement: strictCpuPlacement ?? this.strictCpuPlacement,
+      pollLevel: pollLevel ?? this.pollLevel,
+      numa: numa ?? this.numa,
+      tuningCacheDirectory: tuningCacheDirectory ?? this.tuningCacheDirectory,
+    );
+  }
+}
@@ -1,3 +1,5 @@
+import '../config/lora_config.dart';
+
 /// Parameters controlling the token sampling and generation process.
 ///
 /// Use [GenerationParams] to fine-tune how the model generates text, including
@@ -43,6 +45,9 @@ class GenerationParams {
   /// Default native stream batching threshold by byte size.
   static const int defaultStreamBatchByteThreshold = 512;
 
+  /// Default longest n-gram matched by prompt-lookup decoding.
+  static const int defaultPromptLookupNgramSize = 3;
+
   /// Maximum number of new tokens to generate.
   final int maxTokens;
 
@@ -93,7 +98,8 @@ class GenerationParams {
   /// Reuses matching prompt prefixes from previous requests in the same native
   /// context to reduce prompt ingestion latency.
   ///
-  /// This optimization applies to native text-only generation.
+  /// This optimization applies to native text and multimodal generation;
+  /// multimodal prompts reuse whole unchanged media chunks.
   /// Exact full-prompt replays are conservatively re-ingested to preserve
   /// deterministic parity.
   final bool reusePromptPrefix;
@@ -110,6 +116,33 @@ class GenerationParams {
   /// overhead. Higher values reduce overhead but emit larger chunks.
   final int streamBatchByteThreshold;
 
+  /// LoRA adapter set and scales to apply for this request only.
+  ///
+  /// When `null`, the request runs with the adapters configured on the
+  /// context via `LlamaEngine.setLora`, even if an earlier request applied a
+  /// different set. When set, the native backend switches the context to
+  /// exactly this set before ingesting the prompt. With
+  /// `ModelParams.loraSnapshotBytes` it also keeps warm prompt prefixes per
+  /// adapter set so tenants sharing one context do not invalidate each
+  /// other's caches. An empty list selects the base model.
+  final List<LoraAdapterConfig>? loras;
+
+  /// Maximum number of draft tokens proposed per step by prompt-lookup
+  /// speculative decoding on native backends; `0` disables it.
+  ///
+  /// Drafts are the tokens that followed the latest earlier occurrence of
+  /// the current n-gram suffix in the prompt or output. They are verified in
+  /// one batched decode and rejected positions are rolled back, so output is
+  /// the same as without lookup. Helps most when the output copies from the
+  /// prompt (code edits, quoted sources, JSON rewrites). Ignored for
+  /// recurrent and hybrid models, whose state cannot be rolled back.
+  final int promptLookupDraftTokens;
+
+  /// Longest suffix n-gram that prompt-lookup decoding searches for.
+  ///
+  /// Shorter suffixes are tried when the longest one has no earlier match.
+  final int promptLookupNgramSize;
+
   /// Creates generation parameters with default values.
   const GenerationParams({
     this.maxTokens = 4096,
@@ -128,6 +161,9 @@ class GenerationParams {
     this.reusePromptPrefix = defaultReusePromptPrefix,
     this.streamBatchTokenThreshold = defaultStreamBatchTokenThreshold,
     this.streamBatchByteThreshold = defaultStreamBatchByteThreshold,
+    this.loras,
+    this.promptLookupDraftTokens = 0,
+    this.promptLookupNgramSize = defaultPromptLookupNgramSize,
   });
 
   /// Creates a copy of this [GenerationParams] with updated fields.
@@ -148,6 +184,9 @@ class GenerationParams {
     bool? reusePromptPrefix,
     int? streamBatchTokenThreshold,
     int? streamBatchByteThreshold,
+    List<LoraAdapterConfig>? loras,
+    int? promptLookupDraftTokens,
+    int? promptLookupNgramSize,
   }) {
     return GenerationParams(
       maxTokens: maxTokens ?? this.maxTokens,
@@ -168,6 +207,11 @@ class GenerationParams {
           streamBatchTokenThreshold ?? this.streamBatchTokenThreshold,
       streamBatchByteThreshold:
           streamBatchByteThreshold ?? this.streamBatchByteThreshold,
+      loras: loras ?? this.loras,
+      promptLookupDraftTokens:
+          promptLookupDraftTokens ?? this.promptLookupDraftTokens,
+      promptLookupNgramSize:
+          promptLookupNgramSize ?? this.promptLookupNgramSize,
     );
   }
 }
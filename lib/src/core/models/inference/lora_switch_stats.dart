@@ -0,0 +1,70 @@
+/// Per-context statistics about LoRA adapter set switches.
+///
+/// Reported by native backends when requests carry their own adapter set via
+/// `GenerationParams.loras`. Use it to judge how well request scheduling
+/// groups tenants and how much time adapter swaps cost.
+class LoraSwitchStats {
+  /// Canonical key of the currently applied adapter set.
+  ///
+  /// Empty when only the base model is active.
+  final String activeAdapterSet;
+
+  /// Number of times the active adapter set changed.
+  final int swapCount;
+
+  /// Total time spent switching adapter sets, including loading adapters,
+  /// applying them and saving/restoring prompt prefix snapshots.
+  final Duration totalSwapTime;
+
+  /// Time spent on the most recent switch.
+  final Duration lastSwapTime;
+
+  /// Number of switches that restored a warm prompt prefix for the incoming
+  /// adapter set.
+  final int prefixRestores;
+
+  /// Number of switches that found no warm prompt prefix for the incoming
+  /// adapter set.
+  final int prefixMisses;
+
+  /// Number of adapter sets with a retained prompt prefix snapshot.
+  final int snapshotCount;
+
+  /// Total bytes held by retained prompt prefix snapshots.
+  final int snapshotBytes;
+
+  /// Part of [totalSwapTime] spent copying prompt prefix snapshots out of
+  /// and back into the KV cache.
+  final Duration totalSnapshotTime;
+
+  /// Snapshot copy time of the most recent switch.
+  final Duration lastSnapshotTime;
+
+  /// Creates LoRA switch statistics.
+  const LoraSwitchStats({
+    this.activeAdapterSet = '',
+    this.swapCount = 0,
+    this.totalSwapTime = Duration.zero,
+    this.lastSwapTime = Duration.zero,
+    this.prefixRestores = 0,
+    this.prefixMisses = 0,
+    this.snapshotCount = 0,
+    this.snapshotBytes = 0,
+    this.totalSnapshotTime = Duration.zero,
+    this.lastSnapshotTime = Duration.zero,
+  });
+
+  /// Average time per adapter set switch.
+  Duration get averageSwapTime => swapCount == 0
+      ? Duration.zero
+      : Duration(microseconds: totalSwapTime.inMicroseconds ~/ swapCount);
+
+  @override
+  String toString() {
+    return 'LoraSwitchStats(activeAdapterSet: $activeAdapterSet, '
+        'swapCount: $swapCount, totalSwapTime: $totalSwapTime, '
+        'prefixRestores: $prefixRestores, prefixMisses: $prefixMisses, '
+        'snapshotCount: $snapshotCount, snapshotBytes: $snapshotBytes, '
+        'totalSnapshotTime: $totalSnapshotTime)';
+  }
+}
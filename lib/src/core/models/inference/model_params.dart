@@ -1,6 +1,7 @@
 import '../config/gpu_backend.dart';
 
 import '../config/lora_config.dart';
+import '../config/threading_config.dart';
 
 /// Configuration parameters for loading a Llama model.
 ///
@@ -42,6 +43,23 @@ class ModelParams {
   /// Set to 0 for automatic detection.
   final int numberOfThreadsBatch;
 
+  /// CPU thread tuning, threadpool and NUMA placement settings.
+  final ThreadingConfig threading;
+
+  /// Memory budget, in bytes, for prompt prefix snapshots kept per LoRA
+  /// adapter set.
+  ///
+  /// When requests switch adapter sets via `GenerationParams.loras`, the
+  /// outgoing set's evaluated prompt prefix is copied out of the KV cache so
+  /// a later request for that set can resume from it. Each copy costs time
+  /// proportional to the prefix length, so this is off (0) by default.
+  ///
+  /// With the default, per-set prefix reuse is disabled: every adapter
+  /// switch clears the KV cache and the next request re-ingests its whole
+  /// prompt. Set a budget (for example a few MiB per expected set) to keep
+  /// each set's prefix warm across switches.
+  final int loraSnapshotBytes;
+
   /// Maximum number of GPU layers to safely offload all layers.
   static const int maxGpuLayers = 999;
 
@@ -54,6 +72,8 @@ class ModelParams {
     this.chatTemplate,
     this.numberOfThreads = 0,
     this.numberOfThreadsBatch = 0,
+    this.threading = const ThreadingConfig(),
+    this.loraSnapshotBytes = 0,
   });
 
   /// Creates a copy of this [ModelParams] with updated fields.
@@ -65,6 +85,8 @@ class ModelParams {
     String? chatTemplate,
     int? numberOfThreads,
     int? numberOfThreadsBatch,
+    ThreadingConfig? threading,
+    int? loraSnapshotBytes,
   }) {
     return ModelParams(
       contextSize: contextSize ?? this.contextSize,
@@ -74,6 +96,8 @@ class ModelParams {
       chatTemplate: chatTemplate ?? this.chatTemplate,
       numberOfThreads: numberOfThreads ?? this.numberOfThreads,
       numberOfThreadsBatch: numberOfThreadsBatch ?? this.numberOfThreadsBatch,
+      threading: threading ?? this.threading,
+      loraSnapshotBytes: loraSnapshotBytes ?? this.loraSnapshotBytes,
     );
   }
 }
@@ -0,0 +1,49 @@
+/// Per-context statistics about prompt-lookup speculative decoding.
+///
+/// Reported by native backends for requests that enable
+/// `GenerationParams.promptLookupDraftTokens`. Counters accumulate over the
+/// lifetime of the context.
+class PromptLookupStats {
+  /// Number of tokens sampled by lookup-enabled requests, not counting the
+  /// end-of-generation token.
+  final int generatedTokens;
+
+  /// Number of `llama_decode` calls made by lookup-enabled requests after
+  /// prompt ingestion.
+  final int decodeCalls;
+
+  /// Number of decode calls that verified at least one draft token.
+  final int draftBatches;
+
+  /// Number of draft tokens proposed from n-gram matches.
+  final int draftedTokens;
+
+  /// Number of draft tokens that matched the sampled token and so needed no
+  /// decode of their own.
+  final int acceptedTokens;
+
+  /// Creates prompt-lookup statistics.
+  const PromptLookupStats({
+    this.generatedTokens = 0,
+    this.decodeCalls = 0,
+    this.draftBatches = 0,
+    this.draftedTokens = 0,
+    this.acceptedTokens = 0,
+  });
+
+  /// Fraction of drafted tokens that were accepted.
+  double get acceptanceRate =>
+      draftedTokens == 0 ? 0.0 : acceptedTokens / draftedTokens;
+
+  /// Average number of generated tokens per decode call; 1.0 without
+  /// speculation.
+  double get tokensPerDecode =>
+      decodeCalls == 0 ? 0.0 : generatedTokens / decodeCalls;
+
+  @override
+  String toString() {
+    return 'PromptLookupStats(generatedTokens: $generatedTokens, '
+        'decodeCalls: $decodeCalls, draftBatches: $draftBatches, '
+        'draftedTokens: $draftedTokens, acceptedTokens: $acceptedTokens)';
+  }
+}
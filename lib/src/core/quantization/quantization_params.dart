@@ -0,0 +1,44 @@
+import 'quantization_type.dart';
+
+/// Options for converting a GGUF model to another quantization.
+///
+/// Mirrors the plain-data fields of llama.cpp's
+/// `llama_model_quantize_params`.
+class QuantizationParams {
+  /// Target quantization.
+  final QuantizationType type;
+
+  /// Worker threads used by the quantizer; `0` uses all hardware threads.
+  final int threads;
+
+  /// ggml type name (for example `Q8_0`) forced for `output.weight`, or
+  /// `null` for llama.cpp's default choice.
+  final String? outputTensorType;
+
+  /// ggml type name forced for `token_embd.weight`, or `null` to follow
+  /// [type].
+  final String? tokenEmbeddingType;
+
+  /// Whether tensors that are already quantized may be quantized again.
+  ///
+  /// Requantizing loses more quality than quantizing from F16/BF16/F32.
+  final bool allowRequantize;
+
+  /// Whether `output.weight` is quantized at all.
+  final bool quantizeOutputTensor;
+
+  /// Whether every tensor uses the base type of [type], disabling the
+  /// K-quant layer mixes.
+  final bool pure;
+
+  /// Creates quantization options.
+  const QuantizationParams({
+    required this.type,
+    this.threads = 0,
+    this.outputTensorType,
+    this.tokenEmbeddingType,
+    this.allowRequantize = false,
+    this.quantizeOutputTensor = true,
+    this.pure = false,
+  }) : assert(threads >= 0, 'threads must not be negative');
+}
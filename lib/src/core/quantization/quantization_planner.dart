@@ -0,0 +1,283 @@
+import '../gguf/gguf_model_info.dart';
+import '../gguf/gguf_reader.dart';
+import 'quantization_params.dart';
+import 'quantization_type.dart';
+
+/// Memory limits a model must fit into after quantization.
+class QuantizationBudget {
+  /// Context size the model will run with; 0 or less means the model's
+  /// training context, as with `ModelParams.contextSize`.
+  final int contextSize;
+
+  /// Host memory available for the model, or `null` for no limit.
+  final int? ramBytes;
+
+  /// GPU memory available for the model, or `null` for no limit.
+  final int? vramBytes;
+
+  /// Layers offloaded to the GPU, as in `ModelParams.gpuLayers`.
+  final int gpuLayers;
+
+  /// Creates a memory budget.
+  const QuantizationBudget({
+    required this.contextSize,
+    this.ramBytes,
+    this.vramBytes,
+    this.gpuLayers = 0,
+  });
+
+  /// Whether [estimate] stays within both limits.
+  bool allows(GgufMemoryEstimate estimate) {
+    final ram = ramBytes;
+    final vram = vramBytes;
+    return (ram == null || estimate.ramBytes <= ram) &&
+        (vram == null || estimate.vramBytes <= vram);
+  }
+}
+
+/// Quantization chosen by [pickQuantizationToFit].
+class QuantizationFit {
+  /// Options to quantize with, or `null` when the source model already fits.
+  final QuantizationParams? params;
+
+  /// Predicted header and tensor table of the model that will be loaded.
+  final GgufModelInfo model;
+
+  /// Memory estimate of [model] at the budget's context size.
+  final GgufMemoryEstimate estimate;
+
+  /// Creates a fit result.
+  const QuantizationFit({
+    required this.params,
+    required this.model,
+    required this.estimate,
+  });
+}
+
+/// Returns the `ggml_type` id of the type called [name] (case-insensitive),
+/// or `null` if unknown.
+int? ggmlTypeIdForName(String name) {
+  final upper = name.toUpperCase();
+  for (final MapEntry(:key, :value) in GgmlTypeInfo.known.entries) {
+    if (value.name == upper) return key;
+  }
+  return null;
+}
+
+/// Predicts the tensor table llama.cpp writes when quantizing [source] with
+/// [params].
+///
+/// Follows `llama_tensor_get_type` for the parts that move file size: which
+/// tensors are quantized, the `output.weight` type, `attn_v`/`ffn_down`
+/// upgrades of the K-quant mixes, and fallbacks for rows that do not divide
+/// into whole blocks. Architecture-specific tweaks are ignored, so sizes are
+/// close but not exact.
+///
+/// Throws [ArgumentError] for unknown tensor type overrides.
+GgufModelInfo predictQuantizedModel(
+  GgufModelInfo source,
+  QuantizationParams params,
+) {
+  final outputOverride = _overrideType(params.outputTensorType);
+  final embeddingOverride = _overrideType(params.tokenEmbeddingType);
+  final hasOutput = source.tensors.any((t) => t.name == 'output.weight');
+  final layers = source.blockCount ?? 0;
+  final alignmentValue = source.metadata['general.alignment'];
+  final alignment = alignmentValue is int && alignmentValue > 0
+      ? alignmentValue
+      : 32;
+
+  var offset = 0;
+  final tensors = <GgufTensorInfo>[];
+  for (final tensor in source.tensors) {
+    var type = tensor.type;
+    if (_isQuantizable(tensor, params)) {
+      type = _targetType(tensor, params, layers, hasOutput);
+      if (tensor.name == 'token_embd.weight' && embeddingOverride != null) {
+        type = embeddingOverride;
+      }
+      if (tensor.name == 'output.weight' && outputOverride != null) {
+        type = outputOverride;
+      }
+      type = _compatibleType(type, tensor.shape.first);
+    }
+    final byteSize = type == tensor.type
+        ? tensor.byteSize
+        : _tensorBytes(tensor, type);
+    tensors.add(
+      GgufTensorInfo(
+        name: tensor.name,
+        shape: tensor.shape,
+        type: type,
+        offset: offset,
+        byteSize: byteSize,
+      ),
+    );
+    offset += (byteSize + alignment - 1) ~/ alignment * alignment;
+  }
+
+  return GgufModelInfo(
+    version: source.version,
+    metadata: {
+      ...source.metadata,
+      'general.file_type': params.type.fileType,
+      'general.quantization_version': 2,
+    },
+    tensors: tensors,
+    dataOffset: source.dataOffset,
+    fileSize: source.dataOffset + offset,
+  );
+}
+
+/// Picks the highest-quality quantization of [source] that fits [budget].
+///
+/// Returns a fit without [QuantizationFit.params] when [source] fits as is,
+/// and `null` when even the smallest quantization does not fit. Only types
+/// that shrink the weights are considered; already quantized sources are
+/// requantized.
+QuantizationFit? pickQuantizationToFit(
+  GgufModelInfo source,
+  QuantizationBudget budget,
+) {
+  final sourceEstimate = _estimate(source, budget);
+  if (budget.allows(sourceEstimate)) {
+    return QuantizationFit(
+      params: null,
+      model: source,
+      estimate: sourceEstimate,
+    );
+  }
+
+  final requantize = source.tensors.any((t) => _isQuantizedType(t.type));
+  for (final type in QuantizationType.byQuality) {
+    final params = QuantizationParams(
+      type: type,
+      allowRequantize: requantize,
+    );
+    final model = predictQuantizedModel(source, params);
+    if (model.tensorBytes >= source.tensorBytes) continue;
+    final estimate = _estimate(model, budget);
+    if (budget.allows(estimate)) {
+      return QuantizationFit(params: params, model: model, estimate: estimate);
+    }
+  }
+  return null;
+}
+
+GgufMemoryEstimate _estimate(GgufModelInfo model, QuantizationBudget budget) {
+  // Native contexts use the training context when none is given and set
+  // n_batch = n_ubatch = n_ctx, so compute buffers span the whole context.
+  final contextSize = budget.contextSize > 0
+      ? budget.contextSize
+      : model.contextLength ?? 0;
+  return model.estimateMemory(
+    contextSize: contextSize,
+    gpuLayers: budget.gpuLayers,
+    batchSize: contextSize,
+  );
+}
+
+int? _overrideType(String? name) {
+  if (name == null) return null;
+  final id = ggmlTypeIdForName(name);
+  if (id == null) {
+    throw ArgumentError.value(name, 'name', 'Unknown ggml tensor type');
+  }
+  return id;
+}
+
+bool _isQuantizable(GgufTensorInfo tensor, QuantizationParams params) {
+  final name = tensor.name;
+  if (!name.endsWith('weight')) return false;
+  if (_dimensions(tensor.shape) < 2) return false;
+  if (name.contains('_norm.weight')) return false;
+  if (name == 'output.weight' && !params.quantizeOutputTensor) return false;
+  const excluded = [
+    'ffn_gate_inp.weight',
+    'pos_embd.weight',
+    'token_types.weight',
+    'ssm_conv1d.weight',
+  ];
+  for (final suffix in excluded) {
+    if (name.endsWith(suffix)) return false;
+  }
+  return true;
+}
+
+int _targetType(
+  GgufTensorInfo tensor,
+  QuantizationParams params,
+  int layers,
+  bool hasOutput,
+) {
+  final type = params.type;
+  if (params.pure) return type.baseTensorType;
+
+  final name = tensor.name;
+  if (name == 'output.weight' ||
+      (!hasOutput && name == 'token_embd.weight')) {
+    return type == QuantizationType.q80 ? type.baseTensorType : _ggmlQ6K;
+  }
+
+  final upgrade = name.endsWith('.attn_v.weight')
+      ? type.attentionValueType
+      : name.endsWith('.ffn_down.weight')
+      ? type.feedForwardDownType
+      : null;
+  final block = tensor.blockIndex;
+  if (upgrade != null &&
+      block != null &&
+      (!type.upgradesSomeLayers || _useMoreBits(block, layers))) {
+    return upgrade;
+  }
+  return type.baseTensorType;
+}
+
+/// llama.cpp's `use_more_bits`: the first and last eighth of the layers and
+/// every third layer in between.
+bool _useMoreBits(int layer, int layers) {
+  return layer < layers ~/ 8 ||
+      layer >= 7 * layers ~/ 8 ||
+      (layer - layers ~/ 8) % 3 == 2;
+}
+
+/// Falls back like llama.cpp when rows do not divide into whole blocks.
+int _compatibleType(int type, int rowLength) {
+  if (_fitsRows(type, rowLength)) return type;
+  final fallback = switch (type) {
+    10 || 11 => 20, // Q2_K, Q3_K -> IQ4_NL
+    12 => 6, // Q4_K -> Q5_0
+    13 => 7, // Q5_K -> Q5_1
+    14 => 8, // Q6_K -> Q8_0
+    _ => _ggmlF16,
+  };
+  return _fitsRows(fallback, rowLength) ? fallback : _ggmlF16;
+}
+
+bool _fitsRows(int type, int rowLength) {
+  final info = GgmlTypeInfo.known[type];
+  return info != null && rowLength % info.blockSize == 0;
+}
+
+int _tensorBytes(GgufTensorInfo tensor, int type) {
+  final info = GgmlTypeInfo.known[type]!;
+  final rowLength = tensor.shape.first;
+  final rows = rowLength == 0 ? 0 : tensor.elementCount ~/ rowLength;
+  return rows * (rowLength ~/ info.blockSize) * info.typeSize;
+}
+
+bool _isQuantizedType(int type) {
+  // F32, F16, BF16 and the integer/F64 types are stored unquantized.
+  return !(type == 0 || type == 1 || type == 30 || (type >= 24 && type <= 28));
+}
+
+int _dimensions(List<int> shape) {
+  var dims = shape.length;
+  while (dims > 1 && shape[dims - 1] == 1) {
+    dims--;
+  }
+  return dims;
+}
+
+const int _ggmlF16 = 1;
+const int _ggmlQ6K = 14;
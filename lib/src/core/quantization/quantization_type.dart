@@ -0,0 +1,111 @@
+/// Target quantization for on-device model conversion.
+///
+/// Each value maps to a llama.cpp `llama_ftype`. Types that need an
+/// importance matrix (IQ1/IQ2/IQ3) are not offered because quantization runs
+/// without calibration data.
+enum QuantizationType {
+  /// 2-bit K-quant mix (`Q2_K`); smallest, lowest quality.
+  q2K(10, 'Q2_K', _ggmlQ2K, _ggmlQ3K, _ggmlQ3K, false),
+
+  /// 3-bit K-quant, small mix (`Q3_K_S`).
+  q3KS(11, 'Q3_K_S', _ggmlQ3K),
+
+  /// 3-bit K-quant, medium mix (`Q3_K_M`).
+  q3KM(12, 'Q3_K_M', _ggmlQ3K, _ggmlQ4K, _ggmlQ4K, false),
+
+  /// 3-bit K-quant, large mix (`Q3_K_L`).
+  q3KL(13, 'Q3_K_L', _ggmlQ3K, _ggmlQ5K, _ggmlQ5K, false),
+
+  /// 4-bit legacy quant (`Q4_0`).
+  q40(2, 'Q4_0', _ggmlQ40),
+
+  /// 4-bit legacy quant with offsets (`Q4_1`).
+  q41(3, 'Q4_1', _ggmlQ41),
+
+  /// 4-bit K-quant, small mix (`Q4_K_S`).
+  q4KS(14, 'Q4_K_S', _ggmlQ4K),
+
+  /// 4-bit K-quant, medium mix (`Q4_K_M`); the usual default.
+  q4KM(15, 'Q4_K_M', _ggmlQ4K, _ggmlQ6K, _ggmlQ6K),
+
+  /// 5-bit legacy quant (`Q5_0`).
+  q50(8, 'Q5_0', _ggmlQ50),
+
+  /// 5-bit legacy quant with offsets (`Q5_1`).
+  q51(9, 'Q5_1', _ggmlQ51),
+
+  /// 5-bit K-quant, small mix (`Q5_K_S`).
+  q5KS(16, 'Q5_K_S', _ggmlQ5K),
+
+  /// 5-bit K-quant, medium mix (`Q5_K_M`).
+  q5KM(17, 'Q5_K_M', _ggmlQ5K, _ggmlQ6K, _ggmlQ6K),
+
+  /// 6-bit K-quant (`Q6_K`).
+  q6K(18, 'Q6_K', _ggmlQ6K),
+
+  /// 8-bit quant (`Q8_0`); near-lossless.
+  q80(7, 'Q8_0', _ggmlQ80);
+
+  /// `llama_ftype` value passed to `llama_model_quantize`.
+  final int fileType;
+
+  /// Name used by llama.cpp and in GGUF file names, for example `Q4_K_M`.
+  final String label;
+
+  /// `ggml_type` id used for most weight matrices.
+  final int baseTensorType;
+
+  /// `ggml_type` id used for `attn_v` weights in upgraded layers, if any.
+  final int? attentionValueType;
+
+  /// `ggml_type` id used for `ffn_down` weights in upgraded layers, if any.
+  final int? feedForwardDownType;
+
+  /// Whether only some layers (the first and last eighth and every third
+  /// layer in between) are upgraded, instead of all of them.
+  final bool upgradesSomeLayers;
+
+  const QuantizationType(
+    this.fileType,
+    this.label,
+    this.baseTensorType, [
+    this.attentionValueType,
+    this.feedForwardDownType,
+    this.upgradesSomeLayers = true,
+  ]);
+
+  /// Auto-quantization candidates from highest to lowest quality.
+  static const List<QuantizationType> byQuality = [
+    q80,
+    q6K,
+    q5KM,
+    q5KS,
+    q4KM,
+    q4KS,
+    q3KL,
+    q3KM,
+    q3KS,
+    q2K,
+  ];
+
+  /// Returns the type with [label] (case-insensitive), or `null`.
+  static QuantizationType? fromLabel(String label) {
+    final upper = label.toUpperCase();
+    for (final type in values) {
+      if (type.label == upper) return type;
+    }
+    return null;
+  }
+}
+
+// ggml_type ids referenced above.
+const int _ggmlQ40 = 2;
+const int _ggmlQ41 = 3;
+const int _ggmlQ50 = 6;
+const int _ggmlQ51 = 7;
+const int _ggmlQ80 = 8;
+const int _ggmlQ2K = 10;
+const int _ggmlQ3K = 11;
+const int _ggmlQ4K = 12;
+const int _ggmlQ5K = 13;
+const int _ggmlQ6K = 14;
@@ -0,0 +1,86 @@
+import 'dart:typed_data';
+
+/// Token IDs of many texts packed into one buffer.
+///
+/// The tokens of text `i` occupy `tokens[offsets[i]..offsets[i + 1])`, so a
+/// batch of any size is two typed arrays instead of one list per text.
+class TokenBatch {
+  /// Concatenated token IDs of every text.
+  final Int32List tokens;
+
+  /// Start offset of each text in [tokens], plus a final end offset.
+  final Uint32List offsets;
+
+  /// Creates a batch from its packed arrays.
+  TokenBatch({required this.tokens, required this.offsets}) {
+    if (offsets.isEmpty) {
+      throw ArgumentError('offsets must contain at least one entry');
+    }
+    if (offsets.first != 0 || offsets.last != tokens.length) {
+      throw ArgumentError('offsets must span the token buffer');
+    }
+  }
+
+  /// Packs one token list per text into a batch.
+  factory TokenBatch.fromLists(List<List<int>> lists) {
+    final offsets = Uint32List(lists.length + 1);
+    var total = 0;
+    for (var i = 0; i < lists.length; i++) {
+      total += lists[i].length;
+      offsets[i + 1] = total;
+    }
+    final tokens = Int32List(total);
+    for (var i = 0; i < lists.length; i++) {
+      tokens.setAll(offsets[i], lists[i]);
+    }
+    return TokenBatch(tokens: tokens, offsets: offsets);
+  }
+
+  /// Joins batches in order, as if their texts had been tokenized together.
+  factory TokenBatch.concat(List<TokenBatch> batches) {
+    if (batches.length == 1) return batches.single;
+    var texts = 0;
+    var total = 0;
+    for (final batch in batches) {
+      texts += batch.length;
+      total += batch.tokens.length;
+    }
+    final tokens = Int32List(total);
+    final offsets = Uint32List(texts + 1);
+    var text = 0;
+    var base = 0;
+    for (final batch in batches) {
+      tokens.setAll(base, batch.tokens);
+      for (var i = 1; i <= batch.length; i++) {
+        offsets[text + i] = base + batch.offsets[i];
+      }
+      text += batch.length;
+      base += batch.tokens.length;
+    }
+    return TokenBatch(tokens: tokens, offsets: offsets);
+  }
+
+  /// Number of texts in the batch.
+  int get length => offsets.length - 1;
+
+  /// Returns the tokens of text [index] as a view into [tokens].
+  Int32List operator [](int index) {
+    RangeError.checkValidIndex(index, this, 'index', length);
+    return Int32List.sublistView(tokens, offsets[index], offsets[index + 1]);
+  }
+
+  /// Number of tokens in text [index].
+  int tokenCount(int index) {
+    RangeError.checkValidIndex(index, this, 'index', length);
+    return offsets[index + 1] - offsets[index];
+  }
+
+  /// Token count of every text.
+  Int32List get tokenCounts {
+    final counts = Int32List(length);
+    for (var i = 0; i < counts.length; i++) {
+      counts[i] = offsets[i + 1] - offsets[i];
+    }
+    return counts;
+  }
+}
@@ -0,0 +1,73 @@
+import 'dart:convert';
+import 'dart:typed_data';
+
+/// Incrementally decodes UTF-8 that arrives one token piece at a time.
+///
+/// Token pieces can split a multi-byte code point. [add] returns the text of
+/// every code point completed so far and holds back a trailing partial
+/// sequence (at most three bytes) until the next piece completes it.
+class Utf8Assembler {
+  final Uint8List _pending = Uint8List(3);
+  int _pendingLength = 0;
+
+  /// Number of bytes held back waiting for the rest of a code point.
+  int get pendingBytes => _pendingLength;
+
+  /// Appends [bytes] and returns the newly completed text.
+  String add(List<int> bytes) {
+    if (bytes.isEmpty) return '';
+
+    final Uint8List data;
+    if (_pendingLength == 0) {
+      data = bytes is Uint8List ? bytes : Uint8List.fromList(bytes);
+    } else {
+      data = Uint8List(_pendingLength + bytes.length)
+        ..setRange(0, _pendingLength, _pending)
+        ..setRange(_pendingLength, _pendingLength + bytes.length, bytes);
+    }
+
+    final complete = _completeLength(data);
+    _pendingLength = data.length - complete;
+    _pending.setRange(0, _pendingLength, data, complete);
+    if (complete == 0) return '';
+    return utf8.decode(
+      Uint8List.sublistView(data, 0, complete),
+      allowMalformed: true,
+    );
+  }
+
+  /// Returns any held-back bytes as replacement characters and resets.
+  String flush() {
+    if (_pendingLength == 0) return '';
+    final text = utf8.decode(
+      Uint8List.sublistView(_pending, 0, _pendingLength),
+      allowMalformed: true,
+    );
+    _pendingLength = 0;
+    return text;
+  }
+
+  /// Length of the prefix of [data] that ends on a code point boundary.
+  static int _completeLength(Uint8List data) {
+    final end = data.length;
+    var lead = end - 1;
+    while (lead >= 0 && end - lead <= 3 && data[lead] & 0xc0 == 0x80) {
+      lead--;
+    }
+    if (lead < 0 || data[lead] & 0xc0 == 0x80) {
+      // Stray continuation bytes; let the decoder replace them.
+      return end;
+    }
+    final byte = data[lead];
+    final needed = byte >= 0xf8
+        ? 1
+        : byte >= 0xf0
+        ? 4
+        : byte >= 0xe0
+        ? 3
+        : byte >= 0xc0
+        ? 2
+        : 1;
+    return end - lead < needed ? lead : end;
+  }
+}
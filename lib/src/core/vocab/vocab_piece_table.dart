@@ -0,0 +1,97 @@
+import 'dart:convert';
+import 'dart:typed_data';
+
+/// Byte pieces of every token in a model vocabulary, stored contiguously.
+///
+/// Built once per model by the backend and shared with callers so tokens can
+/// be turned back into text without a round trip to native code. Piece `t`
+/// occupies `bytes[offsets[t]..offsets[t + 1])`.
+class VocabPieceTable {
+  /// Flag for tokens (control and unknown tokens) that render as empty text
+  /// unless special tokens are requested, matching `llama_token_to_piece`.
+  static const int hiddenUnlessSpecial = 1;
+
+  /// Concatenated piece bytes, rendered with special tokens enabled.
+  final Uint8List bytes;
+
+  /// Start offset of each piece in [bytes], plus a final end offset.
+  final Uint32List offsets;
+
+  /// Per-token flags such as [hiddenUnlessSpecial].
+  final Uint8List flags;
+
+  /// Creates a table from its packed arrays.
+  VocabPieceTable({
+    required this.bytes,
+    required this.offsets,
+    required this.flags,
+  }) {
+    if (offsets.length != flags.length + 1) {
+      throw ArgumentError('offsets must have one entry more than flags');
+    }
+    if (offsets.isNotEmpty && offsets.last != bytes.length) {
+      throw ArgumentError('last offset must equal the byte length');
+    }
+  }
+
+  /// Number of tokens in the vocabulary.
+  int get vocabSize => flags.length;
+
+  /// Memory held by the table in bytes.
+  int get byteSize =>
+      bytes.lengthInBytes + offsets.lengthInBytes + flags.lengthInBytes;
+
+  /// Whether [token] renders as empty text unless special tokens are shown.
+  bool isHidden(int token) {
+    _checkToken(token);
+    return flags[token] & hiddenUnlessSpecial != 0;
+  }
+
+  /// Returns the bytes of [token] as a view into [bytes].
+  ///
+  /// Hidden tokens yield an empty list unless [special] is `true`.
+  Uint8List pieceBytes(int token, {bool special = false}) {
+    _checkToken(token);
+    if (!special && flags[token] & hiddenUnlessSpecial != 0) {
+      return Uint8List(0);
+    }
+    return Uint8List.sublistView(bytes, offsets[token], offsets[token + 1]);
+  }
+
+  /// Concatenates the pieces of [tokens] into one byte buffer.
+  Uint8List detokenizeBytes(List<int> tokens, {bool special = false}) {
+    var length = 0;
+    for (final token in tokens) {
+      length += _visibleLength(token, special);
+    }
+    final out = Uint8List(length);
+    var position = 0;
+    for (final token in tokens) {
+      final pieceLength = _visibleLength(token, special);
+      if (pieceLength == 0) continue;
+      out.setRange(position, position + pieceLength, bytes, offsets[token]);
+      position += pieceLength;
+    }
+    return out;
+  }
+
+  /// Decodes [tokens] to text, replacing malformed UTF-8 with U+FFFD.
+  String detokenize(List<int> tokens, {bool special = false}) {
+    return utf8.decode(
+      detokenizeBytes(tokens, special: special),
+      allowMalformed: true,
+    );
+  }
+
+  int _visibleLength(int token, bool special) {
+    _checkToken(token);
+    if (!special && flags[token] & hiddenUnlessSpecial != 0) return 0;
+    return offsets[token + 1] - offsets[token];
+  }
+
+  void _checkToken(int token) {
+    if (token < 0 || token >= flags.length) {
+      throw RangeError.range(token, 0, flags.length - 1, 'token');
+    }
+  }
+}
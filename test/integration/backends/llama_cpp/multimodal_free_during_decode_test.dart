@@ -0,0 +1,110 @@
+@TestOn('vm')
+@Timeout(Duration(minutes: 10))
+library;
+
+import 'dart:ffi';
+import 'dart:typed_data';
+
+import 'package:ffi/ffi.dart';
+import 'package:llamadart/llamadart.dart';
+import 'package:llamadart/src/backends/llama_cpp/llama_cpp_service.dart';
+import 'package:test/test.dart';
+
+import '../../../test_helper.dart';
+
+const _modelUrl =
+    'https://huggingface.co/ggml-org/SmolVLM-500M-Instruct-GGUF/resolve/main/SmolVLM-500M-Instruct-Q8_0.gguf';
+const _mmprojUrl =
+    'https://huggingface.co/ggml-org/SmolVLM-500M-Instruct-GGUF/resolve/main/mmproj-SmolVLM-500M-Instruct-f16.gguf';
+
+void main() {
+  group('Freeing handles while media is decoding', () {
+    late String modelPath;
+    late String mmprojPath;
+
+    setUpAll(() async {
+      modelPath = (await TestHelper.ensureModel(
+        _modelUrl,
+        'SmolVLM-500M-Instruct-Q8_0.gguf',
+      )).path;
+      mmprojPath = (await TestHelper.ensureModel(
+        _mmprojUrl,
+        'mmproj-SmolVLM-500M-Instruct-f16.gguf',
+      )).path;
+    });
+
+    final frees = <String, void Function(LlamaCppService, _Handles)>{
+      'model': (service, handles) => service.freeModel(handles.model),
+      'context': (service, handles) => service.freeContext(handles.context),
+      'projector': (service, handles) =>
+          service.freeMultimodalContext(handles.projector),
+    };
+
+    frees.forEach((name, free) {
+      test('freeing the $name fails the request cleanly', () async {
+        const params = ModelParams(contextSize: 2048, gpuLayers: 0);
+        final service = LlamaCppService();
+        final model = service.loadModel(modelPath, params);
+        final handles = _Handles(
+          model,
+          service.createContext(model, params),
+          service.createMultimodalContext(model, mmprojPath),
+        );
+        final cancelToken = calloc<Int8>();
+        addTearDown(() {
+          service.dispose();
+          calloc.free(cancelToken);
+        });
+
+        final output = service
+            .generate(
+              handles.context,
+              'Describe the image.',
+              const GenerationParams(maxTokens: 4),
+              cancelToken.address,
+              parts: [LlamaImageContent(bytes: _solidBmp(256))],
+            )
+            .toList();
+        // Let the request start its helper-isolate decode, then free under
+        // it the way a worker message would.
+        await Future<void>.delayed(Duration.zero);
+        free(service, handles);
+
+        await expectLater(output, throwsA(isA<Exception>()));
+
+        // The service stays usable afterwards.
+        final reloaded = service.loadModel(modelPath, params);
+        service.freeModel(reloaded);
+      });
+    });
+  });
+}
+
+class _Handles {
+  final int model;
+  final int context;
+  final int projector;
+
+  _Handles(this.model, this.context, this.projector);
+}
+
+/// Encodes a grey 24-bit BMP of [size] x [size] pixels.
+Uint8List _solidBmp(int size) {
+  const headerBytes = 54;
+  final rowBytes = (size * 3 + 3) & ~3;
+  final pixelBytes = rowBytes * size;
+  final data = ByteData(headerBytes + pixelBytes)
+    ..setUint8(0, 0x42)
+    ..setUint8(1, 0x4D)
+    ..setUint32(2, headerBytes + pixelBytes, Endian.little)
+    ..setUint32(10, headerBytes, Endian.little)
+    ..setUint32(14, 40, Endian.little)
+    ..setInt32(18, size, Endian.little)
+    ..setInt32(22, size, Endian.little)
+    ..setUint16(26, 1, Endian.little)
+    ..setUint16(28, 24, Endian.little)
+    ..setUint32(34, pixelBytes, Endian.little);
+  final bytes = data.buffer.asUint8List();
+  bytes.fillRange(headerBytes, bytes.length, 0x80);
+  return bytes;
+}
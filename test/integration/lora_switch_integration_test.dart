@@ -0,0 +1,86 @@
+@TestOn('vm')
+@Timeout(Duration(minutes: 10))
+library;
+
+import 'package:llamadart/llamadart.dart';
+import 'package:test/test.dart';
+
+import '../test_helper.dart';
+
+// Same base model and adapter as llama.cpp's server LoRA tests.
+const _modelUrl =
+    'https://huggingface.co/ggml-org/stories15M_MOE/resolve/main/stories15M_MOE-F16.gguf';
+const _loraUrl =
+    'https://huggingface.co/ggml-org/stories15M_MOE/resolve/main/moe_shakespeare15M.gguf';
+
+void main() {
+  group('Alternating LoRA adapter sets', () {
+    late String modelPath;
+    late String loraPath;
+
+    setUpAll(() async {
+      modelPath = (await TestHelper.ensureModel(
+        _modelUrl,
+        'stories15M_MOE-F16.gguf',
+      )).path;
+      loraPath = (await TestHelper.ensureModel(
+        _loraUrl,
+        'moe_shakespeare15M.gguf',
+      )).path;
+    });
+
+    Future<LlamaEngine> load({int loraSnapshotBytes = 0}) async {
+      final engine = LlamaEngine(LlamaBackend());
+      await engine.loadModel(
+        modelPath,
+        modelParams: ModelParams(
+          contextSize: 512,
+          gpuLayers: 0,
+          loraSnapshotBytes: loraSnapshotBytes,
+        ),
+      );
+      return engine;
+    }
+
+    test('matches a fresh context for every request', () async {
+      const greedy = GenerationParams(maxTokens: 24, temp: 0, penalty: 1.0);
+      final shakespeare = greedy.copyWith(
+        loras: [LoraAdapterConfig(path: loraPath, scale: 1.0)],
+      );
+      final base = greedy.copyWith(loras: const []);
+
+      // Requests share a prompt prefix so restored snapshots are reused.
+      const prefix = 'Once upon a time, in a small village by the sea, ';
+      final requests = [
+        ('${prefix}there lived a', shakespeare),
+        ('${prefix}a little girl', base),
+        ('${prefix}the old king', shakespeare),
+        ('${prefix}a tiny dog', base),
+      ];
+
+      final switching = await load(loraSnapshotBytes: 64 * 1024 * 1024);
+      final reference = await load();
+      addTearDown(() async {
+        await switching.dispose();
+        await reference.dispose();
+      });
+
+      for (final (prompt, params) in requests) {
+        final warm = await switching.generate(prompt, params: params).join();
+        // No snapshots and no prefix reuse: each request starts from an
+        // empty KV cache, as on a freshly created context.
+        final fresh = await reference
+            .generate(prompt, params: params.copyWith(reusePromptPrefix: false))
+            .join();
+
+        expect(warm, isNotEmpty);
+        expect(warm, fresh, reason: 'prompt: $prompt');
+      }
+
+      final stats = await switching.getLoraSwitchStats();
+      expect(stats, isNotNull);
+      expect(stats!.swapCount, requests.length);
+      expect(stats.prefixRestores, greaterThanOrEqualTo(2));
+    });
+  });
+}
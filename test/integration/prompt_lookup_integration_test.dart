@@ -0,0 +1,53 @@
+@TestOn('vm')
+@Timeout(Duration(minutes: 5))
+library;
+
+import 'package:llamadart/llamadart.dart';
+import 'package:test/test.dart';
+
+import '../test_helper.dart';
+
+void main() {
+  late LlamaEngine engine;
+
+  setUpAll(() async {
+    final modelFile = await TestHelper.getTestModel();
+    engine = LlamaEngine(LlamaBackend());
+    await engine.loadModel(
+      modelFile.path,
+      modelParams: const ModelParams(contextSize: 512, gpuLayers: 0),
+    );
+  });
+
+  tearDownAll(() async {
+    await engine.dispose();
+  });
+
+  test('prompt lookup keeps greedy output unchanged', () async {
+    const prompt =
+        'Tom had a red ball. Tom had a red ball and a blue hat. '
+        'Tom had a red ball and a blue hat. Tom had a';
+    const greedy = GenerationParams(
+      maxTokens: 48,
+      temp: 0,
+      penalty: 1.0,
+      reusePromptPrefix: false,
+    );
+
+    final plain = await engine.generate(prompt, params: greedy).join();
+    final drafted = await engine
+        .generate(
+          prompt,
+          params: greedy.copyWith(promptLookupDraftTokens: 8),
+        )
+        .join();
+
+    expect(plain, isNotEmpty);
+    expect(drafted, plain);
+
+    final stats = await engine.getPromptLookupStats();
+    expect(stats, isNotNull);
+    expect(stats!.draftedTokens, greaterThan(0));
+    expect(stats.generatedTokens, lessThanOrEqualTo(greedy.maxTokens));
+  });
+}
@@ -0,0 +1,37 @@
+@TestOn('vm')
+library;
+
+import 'package:llamadart/src/backends/llama_cpp/batch_tokenizer.dart';
+import 'package:test/test.dart';
+
+void main() {
+  group('tokenizerShardBounds', () {
+    test('keeps small batches in one shard', () {
+      expect(tokenizerShardBounds(['a', 'b', 'c'], 8), [0, 3]);
+      expect(tokenizerShardBounds([], 8), [0]);
+    });
+
+    test('balances shards by text length', () {
+      final texts = List.filled(8, 'x' * 10);
+
+      final bounds = tokenizerShardBounds(texts, 4, minShardLength: 10);
+
+      expect(bounds, [0, 2, 4, 6, 8]);
+    });
+
+    test('never uses more shards than threads or texts', () {
+      final texts = ['x' * 100, 'y', 'z' * 100];
+
+      expect(tokenizerShardBounds(texts, 2, minShardLength: 1), [0, 2, 3]);
+      expect(tokenizerShardBounds(texts, 16, minShardLength: 1), [0, 1, 3]);
+      expect(tokenizerShardBounds(texts, 0, minShardLength: 1), [0, 3]);
+    });
+  });
+
+  test('startsWithBosText ignores leading whitespace', () {
+    expect(startsWithBosText('  <s>hello', '<s>'), isTrue);
+    expect(startsWithBosText('hello', '<s>'), isFalse);
+    expect(startsWithBosText('<s>hello', null), isFalse);
+    expect(startsWithBosText('hello', ''), isFalse);
+  });
+}
@@ -0,0 +1,119 @@
+@TestOn('vm')
+library;
+
+import 'package:llamadart/src/backends/llama_cpp/byte_budget_lru_cache.dart';
+import 'package:test/test.dart';
+
+void main() {
+  group('ByteBudgetLruCache', () {
+    test('defers eviction until trim and evicts least recently used', () {
+      final evicted = <int>[];
+      final cache = ByteBudgetLruCache<int>(
+        maxEntries: 2,
+        maxBytes: 1000,
+        onEvict: evicted.add,
+      );
+
+      cache.put('a', 1, 10);
+      cache.put('b', 2, 10);
+      cache.put('c', 3, 10);
+      expect(cache.length, 3);
+      expect(evicted, isEmpty);
+
+      expect(cache.get('a'), 1);
+      cache.trim();
+      expect(evicted, [2]);
+      expect(cache.get('b'), isNull);
+      expect(cache.length, 2);
+    });
+
+    test('enforces byte budget', () {
+      final evicted = <int>[];
+      final cache = ByteBudgetLruCache<int>(
+        maxEntries: 10,
+        maxBytes: 25,
+        onEvict: evicted.add,
+      );
+
+      cache.put('a', 1, 10);
+      cache.put('b', 2, 10);
+      cache.put('c', 3, 10);
+      cache.trim();
+      expect(evicted, [1]);
+      expect(cache.totalBytes, 20);
+    });
+
+    test('trim skips pinned entries until released', () {
+      final evicted = <int>[];
+      final cache = ByteBudgetLruCache<int>(
+        maxEntries: 1,
+        maxBytes: 1000,
+        onEvict: evicted.add,
+      );
+
+      cache.put('a', 1, 10);
+      final lease = cache.acquire('a')!;
+      cache.put('b', 2, 10);
+      cache.get('b');
+      cache.get('a');
+      cache.trim();
+      // 'b' is least recently used now, and 'a' is pinned anyway.
+      expect(evicted, [2]);
+
+      cache.put('c', 3, 10);
+      cache.trim();
+      expect(evicted, [2, 3]);
+      expect(lease.value, 1);
+
+      lease.release();
+      lease.release();
+      cache.put('d', 4, 10);
+      cache.trim();
+      expect(evicted, [2, 3, 1]);
+      expect(cache.acquire('missing'), isNull);
+    });
+
+    test('defers releasing pinned values that are replaced or cleared', () {
+      final evicted = <int>[];
+      final cache = ByteBudgetLruCache<int>(
+        maxEntries: 10,
+        maxBytes: 100,
+        onEvict: evicted.add,
+      );
+
+      cache.put('a', 1, 10);
+      final first = cache.acquire('a')!;
+      final second = cache.acquire('a')!;
+      cache.put('a', 2, 10);
+      expect(evicted, isEmpty);
+      first.release();
+      expect(evicted, isEmpty);
+      second.release();
+      expect(evicted, [1]);
+
+      final pinned = cache.acquire('a')!;
+      cache.clear();
+      expect(evicted, [1]);
+      pinned.release();
+      expect(evicted, [1, 2]);
+    });
+
+    test('releases replaced values and clears all entries', () {
+      final evicted = <int>[];
+      final cache = ByteBudgetLruCache<int>(
+        maxEntries: 10,
+        maxBytes: 100,
+        onEvict: evicted.add,
+      );
+
+      cache.put('a', 1, 10);
+      cache.put('a', 2, 10);
+      expect(evicted, [1]);
+
+      cache.clear();
+      expect(evicted, [1, 2]);
+      expect(cache.length, 0);
+      expect(cache.totalBytes, 0);
+    });
+  });
+}
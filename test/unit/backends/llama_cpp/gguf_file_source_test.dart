@@ -0,0 +1,71 @@
+@TestOn('vm')
+library;
+
+import 'dart:convert';
+import 'dart:io';
+import 'dart:typed_data';
+
+import 'package:llamadart/src/backends/llama_cpp/gguf_file_source.dart';
+import 'package:test/test.dart';
+
+void main() {
+  late Directory tempDir;
+
+  setUp(() {
+    tempDir = Directory.systemTemp.createTempSync('llamadart_gguf_');
+  });
+
+  tearDown(() {
+    if (tempDir.existsSync()) {
+      tempDir.deleteSync(recursive: true);
+    }
+  });
+
+  test('inspectGgufFile reads metadata from disk', () {
+    final name = utf8.encode('general.name');
+    final value = utf8.encode('disk');
+    final header = ByteData(24 + 8 + name.length + 4 + 8 + value.length);
+    var offset = 0;
+    void u32(int v) {
+      header.setUint32(offset, v, Endian.little);
+      offset += 4;
+    }
+
+    void u64(int v) {
+      u32(v);
+      u32(0);
+    }
+
+    void bytes(List<int> b) {
+      for (final byte in b) {
+        header.setUint8(offset++, byte);
+      }
+    }
+
+    bytes(ascii.encode('GGUF'));
+    u32(3);
+    u64(0);
+    u64(1);
+    u64(name.length);
+    bytes(name);
+    u32(8);
+    u64(value.length);
+    bytes(value);
+
+    final file = File('${tempDir.path}/model.gguf')
+      ..writeAsBytesSync(header.buffer.asUint8List());
+
+    final info = inspectGgufFile(file.path);
+
+    expect(info.name, 'disk');
+    expect(info.tensors, isEmpty);
+    expect(info.fileSize, file.lengthSync());
+  });
+
+  test('inspectGgufFile rejects non-GGUF files', () {
+    final file = File('${tempDir.path}/model.bin')
+      ..writeAsBytesSync(List<int>.filled(64, 0x41));
+
+    expect(() => inspectGgufFile(file.path), throwsFormatException);
+  });
+}
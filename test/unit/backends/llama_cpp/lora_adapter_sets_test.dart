@@ -0,0 +1,41 @@
+@TestOn('vm')
+library;
+
+import 'package:llamadart/src/backends/llama_cpp/lora_adapter_sets.dart';
+import 'package:llamadart/src/core/models/config/lora_config.dart';
+import 'package:test/test.dart';
+
+void main() {
+  group('LoraAdapterSets', () {
+    test('null-loras request after a tenant runs with the configured set', () {
+      final sets = LoraAdapterSets()..configure({'style.gguf': 0.5});
+      sets.markApplied(sets.configured);
+
+      final tenant = sets.targetFor(const [
+        LoraAdapterConfig(path: 'tenant.gguf', scale: 0.7),
+      ]);
+      sets.markApplied(tenant);
+      expect(sets.active, {'tenant.gguf': 0.7});
+      expect(sets.configured, {'style.gguf': 0.5});
+
+      final fallback = sets.targetFor(null);
+      sets.markApplied(fallback);
+      expect(fallback, {'style.gguf': 0.5});
+      expect(sets.activeKey, 'style.gguf=0.5');
+    });
+
+    test('an empty request set selects the base model', () {
+      final sets = LoraAdapterSets()..configure({'style.gguf': 1.0});
+
+      expect(sets.targetFor(const []), isEmpty);
+      expect(LoraAdapterSets.keyOf(sets.targetFor(const [])), isEmpty);
+    });
+
+    test('keys do not depend on adapter order', () {
+      expect(
+        LoraAdapterSets.keyOf({'b.gguf': 1.0, 'a.gguf': 0.5}),
+        LoraAdapterSets.keyOf({'a.gguf': 0.5, 'b.gguf': 1.0}),
+      );
+    });
+  });
+}
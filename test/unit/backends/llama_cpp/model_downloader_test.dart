@@ -0,0 +1,251 @@
+@TestOn('vm')
+library;
+
+import 'dart:convert';
+import 'dart:io';
+import 'dart:typed_data';
+
+import 'package:llamadart/src/backends/llama_cpp/model_downloader.dart';
+import 'package:llamadart/src/core/download/model_download_progress.dart';
+import 'package:llamadart/src/core/download/sha256_hasher.dart';
+import 'package:test/test.dart';
+
+void main() {
+  final data = Uint8List.fromList([for (var i = 0; i < 1000; i++) i * 7]);
+  final digest = (Sha256Hasher()..add(data)).close();
+
+  late Directory tempDir;
+  late _ModelServer server;
+  late String destination;
+
+  setUp(() async {
+    tempDir = Directory.systemTemp.createTempSync('llamadart_download_');
+    destination = '${tempDir.path}/model.gguf';
+    server = _ModelServer(data);
+    await server.start();
+  });
+
+  tearDown(() async {
+    await server.close();
+    if (tempDir.existsSync()) {
+      tempDir.deleteSync(recursive: true);
+    }
+  });
+
+  ModelDownloader downloader({int maxAttempts = 4}) => ModelDownloader(
+    connections: 3,
+    chunkSize: 100,
+    maxAttempts: maxAttempts,
+    retryDelay: Duration.zero,
+  );
+
+  test('downloads chunks in parallel and verifies SHA-256', () async {
+    final progress = <ModelDownloadProgress>[];
+
+    final file = await downloader().download(
+      server.uri,
+      destination,
+      sha256: digest.toUpperCase(),
+      onProgress: progress.add,
+    );
+
+    expect(file.readAsBytesSync(), data);
+    expect(File('$destination.part').existsSync(), isFalse);
+    expect(File('$destination.part.json').existsSync(), isFalse);
+    expect(server.ranges, contains('bytes=0-0'));
+    expect(server.ranges, contains('bytes=900-999'));
+    expect(server.ranges.where((r) => r != 'bytes=0-0'), hasLength(10));
+    expect(progress.last.fraction, 1.0);
+  });
+
+  test('resumes from the manifest without refetching chunks', () async {
+    server.failFrom = 500;
+    await expectLater(
+      downloader(maxAttempts: 1).download(server.uri, destination),
+      throwsA(isA<HttpException>()),
+    );
+    final manifest =
+        jsonDecode(File('$destination.part.json').readAsStringSync()) as Map;
+    final completed = (manifest['completed'] as List).cast<int>();
+    expect(completed, isNotEmpty);
+
+    server
+      ..failFrom = null
+      ..ranges.clear();
+    final progress = <ModelDownloadProgress>[];
+    final file = await downloader().download(
+      server.uri,
+      destination,
+      sha256: digest,
+      onProgress: progress.add,
+    );
+
+    expect(file.readAsBytesSync(), data);
+    for (final index in completed) {
+      final refetched = startsWith('bytes=${index * 100}-');
+      expect(server.ranges, isNot(contains(refetched)));
+    }
+    expect(progress.first.resumedBytes, completed.length * 100);
+  });
+
+  test('retries a chunk whose connection closes early', () async {
+    server.truncateNextFrom = 300;
+
+    final file = await downloader().download(
+      server.uri,
+      destination,
+      sha256: digest,
+    );
+
+    expect(file.readAsBytesSync(), data);
+    // The retry continues after the bytes that did arrive.
+    expect(server.ranges, contains('bytes=350-399'));
+  });
+
+  test('falls back to one request without range support', () async {
+    server.supportRanges = false;
+
+    final file = await downloader().download(
+      server.uri,
+      destination,
+      sha256: digest,
+    );
+
+    expect(file.readAsBytesSync(), data);
+    expect(server.ranges, ['bytes=0-0']);
+  });
+
+  test('rejects a checksum mismatch and drops partial data', () async {
+    await expectLater(
+      downloader().download(server.uri, destination, sha256: '00' * 32),
+      throwsA(isA<Exception>()),
+    );
+
+    expect(File(destination).existsSync(), isFalse);
+    expect(File('$destination.part').existsSync(), isFalse);
+    expect(File('$destination.part.json').existsSync(), isFalse);
+  });
+
+  test('reuses a verified existing file without network access', () async {
+    await downloader().download(server.uri, destination, sha256: digest);
+    server.ranges.clear();
+
+    await downloader().download(server.uri, destination, sha256: digest);
+
+    expect(server.ranges, isEmpty);
+  });
+
+  test('redownloads a truncated existing file without a digest', () async {
+    File(destination).writeAsBytesSync(data.sublist(0, 400));
+
+    final file = await downloader().download(server.uri, destination);
+
+    expect(file.readAsBytesSync(), data);
+  });
+
+  test('reuses an existing file whose size matches the remote', () async {
+    File(destination).writeAsBytesSync(data);
+
+    await downloader().download(server.uri, destination);
+
+    expect(server.ranges, ['bytes=0-0']);
+  });
+
+  test('reuses a complete GGUF file without network access', () async {
+    // GGUF v3 header with no tensors and no metadata.
+    final header = ByteData(24)
+      ..setUint32(0, 0x46554747, Endian.little)
+      ..setUint32(4, 3, Endian.little);
+    File(destination).writeAsBytesSync(header.buffer.asUint8List());
+
+    final file = await downloader().download(server.uri, destination);
+
+    expect(file.lengthSync(), 24);
+    expect(server.ranges, isEmpty);
+  });
+
+  test('modelCachePathForUri keeps repository segments', () {
+    final cachePath = modelCachePathForUri(
+      '/cache',
+      Uri.parse('https://huggingface.co/org/repo/resolve/main/m.gguf?x=1'),
+    );
+
+    expect(
+      cachePath,
+      '/cache/huggingface.co/org/repo/resolve/main/m.gguf'.replaceAll(
+        '/',
+        Platform.pathSeparator,
+      ),
+    );
+  });
+}
+
+/// Minimal static file server with HTTP range support.
+class _ModelServer {
+  final Uint8List data;
+  final List<String?> ranges = [];
+  bool supportRanges = true;
+
+  /// Range requests starting at or after this offset fail with HTTP 500.
+  int? failFrom;
+
+  /// The next range request starting at this offset sends half its bytes.
+  int? truncateNextFrom;
+
+  late HttpServer _server;
+
+  _ModelServer(this.data);
+
+  Uri get uri =>
+      Uri.parse('http://127.0.0.1:${_server.port}/org/repo/model.gguf');
+
+  Future<void> start() async {
+    _server = await HttpServer.bind(InternetAddress.loopbackIPv4, 0);
+    _server.listen(_handle);
+  }
+
+  Future<void> close() => _server.close(force: true);
+
+  Future<void> _handle(HttpRequest request) async {
+    final range = request.headers.value(HttpHeaders.rangeHeader);
+    ranges.add(range);
+    final response = request.response;
+    response.headers.set(HttpHeaders.etagHeader, '"v1"');
+
+    final match = supportRanges && range != null
+        ? RegExp(r'^bytes=(\d+)-(\d+)$').firstMatch(range)
+        : null;
+    if (match == null) {
+      response.contentLength = data.length;
+      response.add(data);
+      await response.close();
+      return;
+    }
+
+    final start = int.parse(match[1]!);
+    var end = int.parse(match[2]!);
+    if (end >= data.length) end = data.length - 1;
+
+    final failOffset = failFrom;
+    if (failOffset != null && start >= failOffset) {
+      response.statusCode = HttpStatus.internalServerError;
+      await response.close();
+      return;
+    }
+
+    response.statusCode = HttpStatus.partialContent;
+    response.headers.set(
+      HttpHeaders.contentRangeHeader,
+      'bytes $start-$end/${data.length}',
+    );
+    if (truncateNextFrom == start) {
+      truncateNextFrom = null;
+      // Chunked response that ends before the requested range is complete.
+      response.add(data.sublist(start, start + (end - start + 1) ~/ 2));
+    } else {
+      response.contentLength = end - start + 1;
+      response.add(data.sublist(start, end + 1));
+    }
+    await response.close();
+  }
+}
@@ -0,0 +1,45 @@
+@TestOn('vm')
+library;
+
+import 'package:llamadart/src/backends/llama_cpp/model_quantizer.dart';
+import 'package:llamadart/src/core/quantization/quantization_type.dart';
+import 'package:path/path.dart' as path;
+import 'package:test/test.dart';
+
+void main() {
+  group('quantizedModelCachePath', () {
+    String cachePath({
+      int size = 100,
+      int modified = 1,
+      QuantizationType type = QuantizationType.q4KM,
+    }) {
+      return quantizedModelCachePath(
+        '/cache',
+        '/models/tiny-f16.gguf',
+        size,
+        modified,
+        type,
+      );
+    }
+
+    test('names the file after the source and type', () {
+      final result = cachePath();
+
+      expect(path.dirname(result), path.join('/cache', 'quantized'));
+      expect(
+        path.basename(result),
+        matches(RegExp(r'^tiny-f16-[0-9a-f]{64}\.Q4_K_M\.gguf$')),
+      );
+    });
+
+    test('changes when the source file changes', () {
+      expect(cachePath(), cachePath());
+      expect(cachePath(size: 101), isNot(cachePath()));
+      expect(cachePath(modified: 2), isNot(cachePath()));
+      expect(
+        cachePath(type: QuantizationType.q80),
+        isNot(cachePath().replaceAll('Q4_K_M', 'Q8_0')),
+      );
+    });
+  });
+}
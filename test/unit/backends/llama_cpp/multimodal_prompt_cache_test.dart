@@ -0,0 +1,126 @@
+@TestOn('vm')
+library;
+
+import 'dart:typed_data';
+
+import 'package:llamadart/src/backends/llama_cpp/multimodal_prompt_cache.dart';
+import 'package:test/test.dart';
+
+void main() {
+  group('media cache keys', () {
+    test('are stable for identical content', () {
+      final a = mediaBytesCacheKey('image', [1, 2, 3, 4]);
+      final b = mediaBytesCacheKey('image', Uint8List.fromList([1, 2, 3, 4]));
+      expect(a, b);
+    });
+
+    test('differ for different content and kind', () {
+      final base = mediaBytesCacheKey('image', [1, 2, 3, 4]);
+      expect(mediaBytesCacheKey('image', [1, 2, 3, 5]), isNot(base));
+      expect(mediaBytesCacheKey('audio', [1, 2, 3, 4]), isNot(base));
+    });
+
+    test('file keys include size and modification time', () {
+      final a = mediaFileCacheKey('image', '/tmp/a.png', 10, 100);
+      expect(mediaFileCacheKey('image', '/tmp/a.png', 10, 100), a);
+      expect(mediaFileCacheKey('image', '/tmp/a.png', 11, 100), isNot(a));
+      expect(mediaFileCacheKey('image', '/tmp/a.png', 10, 101), isNot(a));
+    });
+
+    test('bytes keys carry the full SHA-256 of the content', () {
+      expect(
+        mediaBytesCacheKey('image', 'abc'.codeUnits),
+        'image:b:'
+        'ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad',
+      );
+    });
+
+    test('sample keys hash PCM content', () {
+      final a = mediaSamplesCacheKey(Float32List.fromList([0.1, 0.2]));
+      final b = mediaSamplesCacheKey(Float32List.fromList([0.1, 0.2]));
+      final c = mediaSamplesCacheKey(Float32List.fromList([0.1, 0.3]));
+      expect(a, b);
+      expect(a, isNot(c));
+    });
+  });
+
+  group('matchMultimodalPrefix', () {
+    MultimodalChunkSignature text(List<int> tokens) =>
+        MultimodalChunkSignature.text(tokens);
+    MultimodalChunkSignature image(String id, [int nPos = 4]) =>
+        MultimodalChunkSignature.media(id, nPos);
+
+    test('reuses nothing without a cached prompt', () {
+      final match = matchMultimodalPrefix(null, [
+        text([1, 2]),
+      ]);
+      expect(match.reusedPositions, 0);
+      expect(match.chunkIndex, 0);
+    });
+
+    test('reuses leading text and image chunks of a follow-up turn', () {
+      final cached = [
+        text([1, 2, 3]),
+        image('a'),
+        text([7, 8]),
+      ];
+      final next = [
+        text([1, 2, 3]),
+        image('a'),
+        text([7, 8, 9, 10]),
+        image('b'),
+        text([11]),
+      ];
+
+      final match = matchMultimodalPrefix(cached, next);
+      expect(match.chunkIndex, 2);
+      expect(match.tokenOffset, 2);
+      expect(match.reusedPositions, 3 + 4 + 2);
+    });
+
+    test('stops at a changed image', () {
+      final cached = [
+        text([1, 2]),
+        image('a'),
+        text([3]),
+      ];
+      final next = [
+        text([1, 2]),
+        image('b'),
+        text([3]),
+      ];
+
+      final match = matchMultimodalPrefix(cached, next);
+      expect(match.chunkIndex, 1);
+      expect(match.tokenOffset, 0);
+      expect(match.reusedPositions, 2);
+    });
+
+    test('resumes at the next chunk when a text chunk is a cached prefix', () {
+      final cached = [
+        text([1, 2, 3]),
+        image('a'),
+      ];
+      final next = [
+        text([1, 2]),
+        image('b'),
+      ];
+
+      final match = matchMultimodalPrefix(cached, next);
+      expect(match.chunkIndex, 1);
+      expect(match.tokenOffset, 0);
+      expect(match.reusedPositions, 2);
+    });
+
+    test('re-ingests exact full replays', () {
+      final chunks = [
+        text([1, 2]),
+        image('a'),
+        text([3]),
+      ];
+
+      final match = matchMultimodalPrefix(chunks, chunks);
+      expect(match.reusedPositions, 0);
+    });
+  });
+}
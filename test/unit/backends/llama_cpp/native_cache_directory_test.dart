@@ -0,0 +1,42 @@
+@TestOn('vm')
+library;
+
+import 'dart:io';
+
+import 'package:llamadart/src/backends/llama_cpp/native_cache_directory.dart';
+import 'package:path/path.dart' as path;
+import 'package:test/test.dart';
+
+void main() {
+  test('prefers XDG_CACHE_HOME on linux', () {
+    final dir = defaultNativeCacheDirectory(
+      environment: {'XDG_CACHE_HOME': '/xdg', 'HOME': '/home/u'},
+      operatingSystem: 'linux',
+    );
+    expect(dir, path.join('/xdg', 'llamadart'));
+  });
+
+  test('falls back to ~/.cache on linux', () {
+    final dir = defaultNativeCacheDirectory(
+      environment: {'HOME': '/home/u'},
+      operatingSystem: 'linux',
+    );
+    expect(dir, path.join('/home/u', '.cache', 'llamadart'));
+  });
+
+  test('uses Library/Caches on macOS', () {
+    final dir = defaultNativeCacheDirectory(
+      environment: {'HOME': '/Users/u'},
+      operatingSystem: 'macos',
+    );
+    expect(dir, path.join('/Users/u', 'Library', 'Caches', 'llamadart'));
+  });
+
+  test('falls back to the system temp directory on mobile', () {
+    final dir = defaultNativeCacheDirectory(
+      environment: const {},
+      operatingSystem: 'android',
+    );
+    expect(dir, path.join(Directory.systemTemp.path, 'llamadart'));
+  });
+}
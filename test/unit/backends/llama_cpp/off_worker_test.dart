@@ -0,0 +1,57 @@
+@TestOn('vm')
+library;
+
+import 'dart:isolate';
+
+import 'package:llamadart/src/backends/llama_cpp/off_worker.dart';
+import 'package:test/test.dart';
+
+var _runsOnThisIsolate = 0;
+
+int _failingJob() {
+  _runsOnThisIsolate++;
+  throw const FormatException('bad input');
+}
+
+class _UnsendableError implements Exception {
+  final ReceivePort port = ReceivePort();
+
+  @override
+  String toString() => 'unsendable failure';
+}
+
+int _unsendableFailingJob() {
+  _runsOnThisIsolate++;
+  throw _UnsendableError();
+}
+
+void main() {
+  test('runOffWorker returns the helper isolate result', () async {
+    expect(await runOffWorker(() => 6 * 7), 42);
+  });
+
+  test('runOffWorker rethrows job failures without rerunning inline', () async {
+    await expectLater(
+      runOffWorker(_failingJob),
+      throwsA(
+        isA<FormatException>().having((e) => e.message, 'message', 'bad input'),
+      ),
+    );
+    // The job ran on the helper isolate only.
+    expect(_runsOnThisIsolate, 0);
+  });
+
+  test('runOffWorker reports unsendable errors without rerunning', () async {
+    await expectLater(
+      runOffWorker(_unsendableFailingJob),
+      throwsA(
+        isA<RemoteError>().having(
+          (e) => e.toString(),
+          'message',
+          contains('unsendable failure'),
+        ),
+      ),
+    );
+    expect(_runsOnThisIsolate, 0);
+  });
+}
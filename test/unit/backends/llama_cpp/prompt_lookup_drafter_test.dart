@@ -0,0 +1,65 @@
+@TestOn('vm')
+library;
+
+import 'package:llamadart/src/backends/llama_cpp/prompt_lookup_drafter.dart';
+import 'package:test/test.dart';
+
+void main() {
+  group('PromptLookupDrafter', () {
+    test('drafts the tokens that followed the matching suffix', () {
+      final drafter = PromptLookupDrafter(
+        promptTokens: [1, 2, 3, 4, 5, 6, 7, 9, 9],
+      );
+      drafter
+        ..add(2)
+        ..add(3);
+
+      expect(drafter.draft(3), [4, 5, 6]);
+      expect(drafter.draft(10), [4, 5, 6, 7, 9, 9, 2, 3]);
+    });
+
+    test('prefers the longest matching n-gram', () {
+      // The suffix [7, 1] continues with 8; the bare [1] last continued
+      // with 9.
+      final drafter = PromptLookupDrafter(
+        maxNgramSize: 2,
+        promptTokens: [7, 1, 8, 5, 1, 9, 6, 7, 1],
+      );
+
+      expect(drafter.draft(1), [8]);
+    });
+
+    test('uses the most recent occurrence', () {
+      final drafter = PromptLookupDrafter(
+        maxNgramSize: 2,
+        promptTokens: [1, 2, 3, 1, 2, 4, 1, 2],
+      );
+
+      expect(drafter.draft(2), [4, 1]);
+    });
+
+    test('drafts from generated tokens', () {
+      final drafter = PromptLookupDrafter(maxNgramSize: 2);
+      for (final token in [10, 11, 12, 13, 10, 11]) {
+        drafter.add(token);
+      }
+
+      expect(drafter.length, 6);
+      expect(drafter.draft(4), [12, 13, 10, 11]);
+    });
+
+    test('returns nothing without a match or budget', () {
+      final drafter = PromptLookupDrafter(
+        minNgramSize: 2,
+        promptTokens: [1, 2, 3, 4],
+      );
+
+      expect(drafter.draft(4), isEmpty);
+      drafter.add(1);
+      expect(drafter.draft(4), isEmpty);
+      drafter.add(2);
+      expect(drafter.draft(4), [3, 4, 1, 2]);
+      expect(drafter.draft(0), isEmpty);
+    });
+  });
+}
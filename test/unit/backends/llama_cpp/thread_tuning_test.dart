@@ -0,0 +1,89 @@
+@TestOn('vm')
+library;
+
+import 'dart:io';
+
+import 'package:llamadart/src/backends/llama_cpp/thread_tuning.dart';
+import 'package:path/path.dart' as path;
+import 'package:test/test.dart';
+
+void main() {
+  group('threadCountCandidates', () {
+    test('uses quarters of the logical CPU count', () {
+      expect(threadCountCandidates(16), [4, 8, 12, 16]);
+    });
+
+    test('deduplicates and clamps small hosts', () {
+      expect(threadCountCandidates(2), [1, 2]);
+      expect(threadCountCandidates(0), [1]);
+    });
+  });
+
+  group('fastestThreadCount', () {
+    test('picks the lowest elapsed time', () {
+      expect(fastestThreadCount({4: 900, 8: 500, 16: 700}), 8);
+    });
+
+    test('prefers fewer threads within tolerance', () {
+      expect(fastestThreadCount({8: 1010, 16: 1000}), 8);
+      expect(fastestThreadCount({8: 1100, 16: 1000}), 16);
+    });
+  });
+
+  test('cache keys separate hosts, quantizations and offload', () {
+    String key({
+      String host = 'h',
+      String desc = 'llama 7B Q4_K - Medium',
+      int gpuLayers = 0,
+    }) => threadTuningCacheKey(
+      host: host,
+      logicalCpus: 16,
+      modelDescription: desc,
+      modelSizeBytes: 100,
+      gpuLayers: gpuLayers,
+    );
+
+    expect(key(), key());
+    expect(key(host: 'other'), isNot(key()));
+    expect(key(desc: 'llama 7B Q8_0'), isNot(key()));
+    expect(key(gpuLayers: 10), isNot(key()));
+  });
+
+  group('ThreadTuningCache', () {
+    late Directory temp;
+
+    setUp(() {
+      temp = Directory.systemTemp.createTempSync('llamadart_tuning_');
+    });
+
+    tearDown(() {
+      temp.deleteSync(recursive: true);
+    });
+
+    test('round-trips results through the cache file', () {
+      final file = File(path.join(temp.path, 'nested', 'tuning.json'));
+      ThreadTuningCache(file).store(
+        'k',
+        const ThreadTuningResult(decodeThreads: 6, batchThreads: 12),
+      );
+
+      final result = ThreadTuningCache(file).lookup('k');
+      expect(result?.decodeThreads, 6);
+      expect(result?.batchThreads, 12);
+      expect(ThreadTuningCache(file).lookup('missing'), isNull);
+    });
+
+    test('ignores corrupt cache files', () {
+      final file = File(path.join(temp.path, 'tuning.json'))
+        ..writeAsStringSync('{not json');
+      final cache = ThreadTuningCache(file);
+
+      expect(cache.lookup('k'), isNull);
+      cache.store(
+        'k',
+        const ThreadTuningResult(decodeThreads: 2, batchThreads: 4),
+      );
+      expect(cache.lookup('k')?.batchThreads, 4);
+    });
+  });
+}
@@ -51,6 +51,20 @@ void main() {
       expect(req.addSpecial, true);
     });
 
+    test('PromptLookupStatsRequest', () {
+      final req = PromptLookupStatsRequest(3, sp);
+      expect(req.contextHandle, 3);
+      expect(req.sendPort, sp);
+    });
+
+    test('TokenizeBatchRequest', () {
+      final req = TokenizeBatchRequest(1, ['a', 'b'], false, true, 4, sp);
+      expect(req.texts, ['a', 'b']);
+      expect(req.addSpecial, false);
+      expect(req.countOnly, true);
+      expect(req.threads, 4);
+    });
+
     test('DetokenizeRequest', () {
       final req = DetokenizeRequest(1, [1, 2], false, sp);
       expect(req.tokens, [1, 2]);
@@ -117,6 +131,8 @@ void main() {
 
     test('Responses', () {
       expect(HandleResponse(1).handle, 1);
+      expect(ModelLoadResponse(2, null).handle, 2);
+      expect(ModelLoadResponse(2, null).modelInfo, isNull);
       expect(TokenResponse([1]).bytes, [1]);
       expect(TokenizeResponse([1]).tokens, [1]);
       expect(DetokenizeResponse('t').text, 't');
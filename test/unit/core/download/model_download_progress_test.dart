@@ -0,0 +1,16 @@
+import 'package:llamadart/src/core/download/model_download_progress.dart';
+import 'package:test/test.dart';
+
+void main() {
+  test('fraction is clamped and null without a total', () {
+    expect(
+      const ModelDownloadProgress(receivedBytes: 25, totalBytes: 100).fraction,
+      0.25,
+    );
+    expect(
+      const ModelDownloadProgress(receivedBytes: 200, totalBytes: 100).fraction,
+      1.0,
+    );
+    expect(const ModelDownloadProgress(receivedBytes: 10).fraction, isNull);
+  });
+}
@@ -0,0 +1,73 @@
+import 'dart:convert';
+import 'dart:typed_data';
+
+import 'package:llamadart/src/core/download/sha256_hasher.dart';
+import 'package:test/test.dart';
+
+void main() {
+  String digest(List<int> bytes) => (Sha256Hasher()..add(bytes)).close();
+
+  final sample = Uint8List.fromList([for (var i = 0; i < 1000; i++) i % 251]);
+  const sampleDigest =
+      '4e4c294b331f7a2099a379bec34b9f9fc03dc46ab465d998f4d683da53487e6d';
+
+  test('matches FIPS 180-2 test vectors', () {
+    expect(
+      digest(const []),
+      'e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855',
+    );
+    expect(
+      digest(ascii.encode('abc')),
+      'ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad',
+    );
+    expect(
+      digest(
+        ascii.encode(
+          'abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq',
+        ),
+      ),
+      '248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1',
+    );
+  });
+
+  test('digestOf hashes a whole buffer', () {
+    expect(Sha256Hasher.digestOf(sample), sampleDigest);
+    expect(Sha256Hasher.digestOf(sample.toList()), sampleDigest);
+  });
+
+  test('is independent of how input is split', () {
+    final hasher = Sha256Hasher();
+    var offset = 0;
+    for (final size in [1, 63, 64, 65, 7, 300]) {
+      hasher.add(sample, offset, offset + size);
+      offset += size;
+    }
+    hasher.add(sample.toList(), offset);
+
+    expect(hasher.length, sample.length);
+    expect(hasher.close(), sampleDigest);
+  });
+
+  test('resumes from serialized state', () {
+    final first = Sha256Hasher()..add(sample, 0, 333);
+    final json = jsonDecode(jsonEncode(first.toJson()));
+
+    final resumed = Sha256Hasher.fromJson(json)!..add(sample, 333);
+
+    expect(resumed.close(), sampleDigest);
+  });
+
+  test('rejects malformed state', () {
+    expect(Sha256Hasher.fromJson(null), isNull);
+    expect(Sha256Hasher.fromJson({'state': [1, 2], 'length': 0}), isNull);
+    final json = Sha256Hasher().toJson()..['length'] = 5;
+    expect(Sha256Hasher.fromJson(json), isNull);
+  });
+
+  test('close is idempotent and seals the hasher', () {
+    final hasher = Sha256Hasher()..add(sample);
+    expect(hasher.close(), sampleDigest);
+    expect(hasher.close(), sampleDigest);
+    expect(() => hasher.add(const [1]), throwsStateError);
+  });
+}
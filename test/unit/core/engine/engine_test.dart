@@ -1,5 +1,6 @@
 import 'dart:async';
 import 'dart:convert';
+import 'dart:typed_data';
 import 'package:test/test.dart';
 import 'package:llamadart/llamadart.dart';
 
@@ -18,6 +19,8 @@ class MockLlamaBackend implements LlamaBackend {
   int modelMetadataCalls = 0;
   String generationText = 'response';
   List<String>? generationChunks;
+  final List<List<LoraAdapterConfig>?> generateLoras = [];
+  final List<String> generateEvents = [];
   final String backendName;
   final bool urlLoadingSupported;
 
@@ -61,13 +64,21 @@ class MockLlamaBackend implements LlamaBackend {
     GenerationParams params, {
     List<LlamaContentPart>? parts,
   }) async* {
-    if (generationChunks != null) {
-      for (final chunk in generationChunks!) {
-        yield utf8.encode(chunk);
+    generateLoras.add(params.loras);
+    generateEvents.add('start $prompt');
+    try {
+      // Give other queued requests a chance to interleave.
+      await Future<void>.delayed(Duration.zero);
+      if (generationChunks != null) {
+        for (final chunk in generationChunks!) {
+          yield utf8.encode(chunk);
+        }
+        return;
       }
-      return;
+      yield utf8.encode(generationText);
+    } finally {
+      generateEvents.add('end $prompt');
     }
-    yield utf8.encode(generationText);
   }
 
   @override
@@ -167,6 +178,129 @@ class MockLlamaBackend implements LlamaBackend {
   }
 }
 
+class DownloadingMockBackend extends MockLlamaBackend
+    implements LlamaModelDownloadBackend {
+  String? downloadedUrl;
+  String? downloadedSha256;
+
+  @override
+  Future<String> downloadModel(
+    String url, {
+    String? sha256,
+    Function(double progress)? onProgress,
+  }) async {
+    downloadedUrl = url;
+    downloadedSha256 = sha256;
+    onProgress?.call(1.0);
+    return '/cache/model.gguf';
+  }
+}
+
+class QuantizingMockBackend extends MockLlamaBackend
+    implements LlamaQuantizationBackend {
+  QuantizationBudget? lastBudget;
+  String? lastLoadedPath;
+  bool cancelled = false;
+
+  @override
+  Future<int> modelLoad(String path, ModelParams params) {
+    lastLoadedPath = path;
+    return super.modelLoad(path, params);
+  }
+
+  @override
+  Future<void> quantizeModel(
+    String inputPath,
+    String outputPath,
+    QuantizationParams params, {
+    Function(double progress)? onProgress,
+  }) async {
+    throw Exception('disk full');
+  }
+
+  @override
+  void cancelQuantization() {
+    cancelled = true;
+  }
+
+  @override
+  Future<String> quantizeModelToFit(
+    String path,
+    QuantizationBudget budget, {
+    Function(double progress)? onProgress,
+  }) async {
+    lastBudget = budget;
+    onProgress?.call(1.0);
+    return '/cache/quantized/model.Q4_K_M.gguf';
+  }
+}
+
+class BatchTokenizerMockBackend extends MockLlamaBackend
+    implements LlamaBatchTokenizerBackend {
+  int? lastThreads;
+
+  @override
+  Future<TokenBatch> tokenizeBatch(
+    int modelHandle,
+    List<String> texts, {
+    bool addSpecial = true,
+    int? threads,
+  }) async {
+    lastThreads = threads;
+    return TokenBatch.fromLists([
+      for (final text in texts) [for (var i = 0; i < text.length; i++) i],
+    ]);
+  }
+
+  @override
+  Future<Int32List> countTokensBatch(
+    int modelHandle,
+    List<String> texts, {
+    bool addSpecial = true,
+    int? threads,
+  }) async {
+    lastThreads = threads;
+    return Int32List.fromList([for (final text in texts) text.length]);
+  }
+}
+
+class VocabMockBackend extends MockLlamaBackend implements LlamaVocabBackend {
+  int pieceTableCalls = 0;
+
+  @override
+  Future<VocabPieceTable> vocabPieceTable(int modelHandle) async {
+    pieceTableCalls += 1;
+    return VocabPieceTable(
+      bytes: Uint8List.fromList(utf8.encode('<s>hi there')),
+      offsets: Uint32List.fromList([0, 3, 5, 11]),
+      flags: Uint8List.fromList([VocabPieceTable.hiddenUnlessSpecial, 0, 0]),
+    );
+  }
+}
+
+class InspectingMockBackend extends MockLlamaBackend
+    implements LlamaModelInspectionBackend {
+  int inspectCalls = 0;
+
+  @override
+  Future<GgufModelInfo> inspectModel(String path) async {
+    inspectCalls += 1;
+    return _info;
+  }
+
+  @override
+  GgufModelInfo? loadedModelInfo(int modelHandle) =>
+      modelLoadCalls > 0 ? _info : null;
+
+  static const _info = GgufModelInfo(
+    version: 3,
+    metadata: {'general.architecture': 'llama', 'llama.context_length': 8192},
+    tensors: [],
+    dataOffset: 32,
+    fileSize: 32,
+  );
+}
+
 void main() {
   late MockLlamaBackend backend;
   late LlamaEngine engine;
@@ -200,6 +334,25 @@ void main() {
       );
     });
 
+    test('loadModelFromUrl downloads then loads on native backends', () async {
+      final nativeBackend = DownloadingMockBackend();
+      final nativeEngine = LlamaEngine(nativeBackend);
+      final progress = <double>[];
+
+      await nativeEngine.loadModelFromUrl(
+        'https://example.com/model.gguf',
+        sha256: 'abc',
+        onProgress: progress.add,
+      );
+
+      expect(nativeBackend.downloadedUrl, 'https://example.com/model.gguf');
+      expect(nativeBackend.downloadedSha256, 'abc');
+      expect(nativeBackend.modelLoadCalls, 1);
+      expect(nativeBackend.modelLoadFromUrlCalls, 0);
+      expect(progress, [1.0]);
+      expect(nativeEngine.isReady, isTrue);
+    });
+
     test(
       'loadModelFromUrl marks engine ready on URL-capable backend',
       () async {
@@ -241,6 +394,99 @@ void main() {
       expect(text, 'decoded');
     });
 
+    test('detokenize uses the vocabulary piece table when exported', () async {
+      final vocabBackend = VocabMockBackend();
+      final vocabEngine = LlamaEngine(vocabBackend);
+      await vocabEngine.loadModel('qwen-test.gguf');
+
+      expect(await vocabEngine.detokenize([0, 1, 2]), 'hi there');
+      expect(await vocabEngine.detokenize([0, 1], special: true), '<s>hi');
+      expect(vocabBackend.pieceTableCalls, 1);
+    });
+
+    test('loadModelToFit loads the quantized copy', () async {
+      final quantBackend = QuantizingMockBackend();
+      final quantEngine = LlamaEngine(quantBackend);
+      final progress = <double>[];
+
+      await quantEngine.loadModelToFit(
+        'model.gguf',
+        ramBudgetBytes: 4 << 30,
+        modelParams: const ModelParams(contextSize: 2048),
+        onProgress: progress.add,
+      );
+
+      expect(
+        quantBackend.lastLoadedPath,
+        '/cache/quantized/model.Q4_K_M.gguf',
+      );
+      expect(quantBackend.lastBudget!.contextSize, 2048);
+      expect(quantBackend.lastBudget!.ramBytes, 4 << 30);
+      // Without a VRAM budget the model is sized for the CPU.
+      expect(quantBackend.lastBudget!.gpuLayers, 0);
+      expect(progress, [1.0]);
+      expect(quantEngine.isReady, isTrue);
+
+      quantEngine.cancelQuantization();
+      expect(quantBackend.cancelled, isTrue);
+    });
+
+    test('quantizeModel wraps backend failures', () async {
+      final quantEngine = LlamaEngine(QuantizingMockBackend());
+
+      await expectLater(
+        quantEngine.quantizeModel(
+          'in.gguf',
+          'out.gguf',
+          const QuantizationParams(type: QuantizationType.q4KM),
+        ),
+        throwsA(isA<LlamaModelException>()),
+      );
+      await expectLater(
+        engine.quantizeModel(
+          'in.gguf',
+          'out.gguf',
+          const QuantizationParams(type: QuantizationType.q4KM),
+        ),
+        throwsA(isA<LlamaUnsupportedException>()),
+      );
+    });
+
+    test('loadModelToFit loads directly without quantization support', () {
+      return engine.loadModelToFit('model.gguf', ramBudgetBytes: 1).then((_) {
+        expect(engine.isReady, isTrue);
+      });
+    });
+
+    test('tokenizeBatch falls back to per-text tokenize', () async {
+      await engine.loadModel('qwen-test.gguf');
+
+      final batch = await engine.tokenizeBatch(['a', 'b']);
+      final counts = await engine.countTokensBatch(['a', 'b']);
+
+      expect(batch.offsets, [0, 3, 6]);
+      expect(batch[1], [1, 2, 3]);
+      expect(counts, [3, 3]);
+      expect(backend.tokenizeCalls, 4);
+    });
+
+    test('tokenizeBatch uses the backend batch tokenizer', () async {
+      final batchBackend = BatchTokenizerMockBackend();
+      final batchEngine = LlamaEngine(batchBackend);
+      await batchEngine.loadModel('qwen-test.gguf');
+
+      final batch = await batchEngine.tokenizeBatch(['ab', 'c'], threads: 2);
+      expect(batch.tokenCounts, [2, 1]);
+      expect(batchBackend.lastThreads, 2);
+      expect(await batchEngine.countTokensBatch(['abcd']), [4]);
+      expect(batchBackend.tokenizeCalls, 0);
+    });
+
+    test('getVocabPieceTable returns null without backend support', () async {
+      await engine.loadModel('qwen-test.gguf');
+      expect(await engine.getVocabPieceTable(), isNull);
+    });
+
     test('chatTemplate', () async {
       await engine.loadModel('qwen-test.gguf');
       final result = await engine.chatTemplate([
@@ -728,6 +974,80 @@ void main() {
       expect(backend.lastLoraPath, isNull);
     });
 
+    test('generate runs per-request LoRA sets and reports stats', () async {
+      await engine.loadModel('qwen-test.gguf');
+      const tenant = [LoraAdapterConfig(path: 'tenant.gguf')];
+      const tenantParams = GenerationParams(loras: tenant);
+      const baseParams = GenerationParams(loras: []);
+
+      final results = await Future.wait([
+        engine.generate('a', params: tenantParams).join(),
+        engine.generate('b', params: baseParams).join(),
+        engine.generate('c', params: tenantParams).join(),
+        engine.generate('d').join(),
+        engine.generate('e').join(),
+      ]);
+
+      expect(results, everyElement('response'));
+      // One request at a time; queued requests for the applied set go first,
+      // and requests without loras are grouped as the context default.
+      expect(backend.generateEvents, [
+        'start a',
+        'end a',
+        'start c',
+        'end c',
+        'start b',
+        'end b',
+        'start d',
+        'end d',
+        'start e',
+        'end e',
+      ]);
+      expect(backend.generateLoras, [tenant, tenant, isEmpty, null, null]);
+      expect(await engine.getLoraSwitchStats(), isNull);
+    });
+
+    test('generate without loras waits for a running tenant request', () async {
+      await engine.loadModel('qwen-test.gguf');
+      const tenant = [LoraAdapterConfig(path: 'tenant.gguf', scale: 0.7)];
+      const tenantParams = GenerationParams(loras: tenant);
+
+      await Future.wait([
+        engine.generate('a', params: tenantParams).join(),
+        engine.generate('b').join(),
+      ]);
+
+      expect(backend.generateEvents, ['start a', 'end a', 'start b', 'end b']);
+      expect(backend.generateLoras, [tenant, null]);
+    });
+
+    test('getPromptLookupStats returns null without backend support', () async {
+      await engine.loadModel('qwen-test.gguf');
+      expect(await engine.getPromptLookupStats(), isNull);
+    });
+
+    test('inspectModel returns null without backend support', () async {
+      expect(await engine.inspectModel('qwen-test.gguf'), isNull);
+      await engine.loadModel('qwen-test.gguf');
+      expect(engine.modelInfo, isNull);
+      expect(backend.modelMetadataCalls, 0);
+    });
+
+    test('loadModel takes model info from the load response', () async {
+      final inspecting = InspectingMockBackend();
+      final inspectingEngine = LlamaEngine(inspecting);
+
+      await inspectingEngine.loadModel('qwen-test.gguf');
+
+      expect(inspecting.inspectCalls, 0);
+      expect(inspectingEngine.modelInfo?.architecture, 'llama');
+      expect(
+        (await inspectingEngine.getMetadata())['llama.context_length'],
+        '8192',
+      );
+      expect(inspecting.modelMetadataCalls, 0);
+    });
+
     test('cancelGeneration', () {
       engine.cancelGeneration();
       // Should not throw
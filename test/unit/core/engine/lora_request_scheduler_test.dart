@@ -0,0 +1,80 @@
+import 'package:llamadart/src/core/engine/lora_request_scheduler.dart';
+import 'package:test/test.dart';
+
+void main() {
+  Future<List<String>> runOrder(
+    LoraRequestScheduler scheduler,
+    String first,
+    List<String> queued,
+  ) async {
+    final order = <String>[];
+    final running = await scheduler.acquire(first);
+    order.add(first);
+
+    final pending = [
+      for (final adapterSet in queued)
+        scheduler.acquire(adapterSet).then((lease) {
+          order.add(adapterSet);
+          lease.release();
+        }),
+    ];
+    running.release();
+    await Future.wait(pending);
+    return order;
+  }
+
+  test('grants immediately when idle', () async {
+    final scheduler = LoraRequestScheduler();
+    final lease = await scheduler.acquire('a');
+
+    expect(scheduler.activeAdapterSet, 'a');
+    expect(scheduler.pendingCount, 0);
+    lease.release();
+  });
+
+  test('groups queued requests by the active adapter set', () async {
+    final scheduler = LoraRequestScheduler();
+    final order = await runOrder(scheduler, 'a', ['b', 'a', 'b', 'a']);
+
+    expect(order, ['a', 'a', 'a', 'b', 'b']);
+  });
+
+  test('caps consecutive grants so other sets are not starved', () async {
+    final scheduler = LoraRequestScheduler(maxConsecutive: 2);
+    final order = await runOrder(scheduler, 'a', ['b', 'a', 'a', 'a']);
+
+    expect(order, ['a', 'a', 'b', 'a', 'a']);
+  });
+
+  test('groups context-default requests apart from the base model', () async {
+    const contextDefault = LoraRequestScheduler.contextDefaultSet;
+    final scheduler = LoraRequestScheduler();
+    final order = await runOrder(scheduler, contextDefault, [
+      '',
+      contextDefault,
+      '',
+    ]);
+
+    expect(order, [contextDefault, contextDefault, '', '']);
+  });
+
+  test('double release does not grant twice', () async {
+    final scheduler = LoraRequestScheduler();
+    final first = await scheduler.acquire('a');
+    var granted = 0;
+    final second = scheduler.acquire('b').then((lease) {
+      granted++;
+      return lease;
+    });
+    final third = scheduler.acquire('c').then((lease) {
+      granted++;
+      return lease;
+    });
+
+    first.release();
+    first.release();
+    (await second).release();
+    await third;
+    expect(granted, 2);
+  });
+}
@@ -0,0 +1,105 @@
+import 'package:llamadart/src/core/gguf/gguf_model_info.dart';
+import 'package:llamadart/src/core/gguf/gguf_reader.dart';
+import 'package:test/test.dart';
+
+void main() {
+  GgufModelInfo buildInfo({int fileSize = 1 << 20}) {
+    return GgufModelInfo(
+      version: 3,
+      metadata: {
+        'general.architecture': 'llama',
+        'general.name': 'Tiny',
+        'general.file_type': 15,
+        'llama.block_count': 2,
+        'llama.embedding_length': 64,
+        'llama.attention.head_count': 8,
+        'llama.attention.head_count_kv': 2,
+        'llama.rope.freq_base': 10000.0,
+        'tokenizer.ggml.tokens': const GgufArrayInfo(GgufValueType.string, 100),
+        'tokenizer.ggml.scores': [0.0, 1.0],
+      },
+      tensors: const [
+        GgufTensorInfo(
+          name: 'token_embd.weight',
+          shape: [64, 100],
+          type: 1,
+          offset: 0,
+          byteSize: 12800,
+        ),
+        GgufTensorInfo(
+          name: 'blk.0.ffn_up.weight',
+          shape: [256, 64],
+          type: 12,
+          offset: 12800,
+          byteSize: 9216,
+        ),
+        GgufTensorInfo(
+          name: 'blk.1.ffn_up.weight',
+          shape: [256, 64],
+          type: 12,
+          offset: 22016,
+          byteSize: 9216,
+        ),
+        GgufTensorInfo(
+          name: 'output.weight',
+          shape: [64, 100],
+          type: 1,
+          offset: 31232,
+          byteSize: 12800,
+        ),
+      ],
+      dataOffset: 1024,
+      fileSize: fileSize,
+    );
+  }
+
+  test('exposes architecture hyperparameters', () {
+    final info = buildInfo();
+
+    expect(info.name, 'Tiny');
+    expect(info.blockCount, 2);
+    expect(info.headCountKv, 2);
+    expect(info.vocabularySize, 100);
+    expect(info.fileTypeName, 'Q4_K_M');
+    expect(info.parameterCount, 64 * 100 * 2 + 256 * 64 * 2);
+  });
+
+  test('formats metadata like llama.cpp and omits arrays', () {
+    final strings = buildInfo().toMetadataStrings();
+
+    expect(strings['llama.block_count'], '2');
+    expect(strings['llama.rope.freq_base'], '10000.000000');
+    expect(strings.containsKey('tokenizer.ggml.tokens'), isFalse);
+    expect(strings.containsKey('tokenizer.ggml.scores'), isFalse);
+  });
+
+  test('groups tensors by quantization type', () {
+    final mix = buildInfo().quantizationMix;
+
+    expect(mix.map((s) => s.typeName), ['F16', 'Q4_K']);
+    expect(mix.first.tensorCount, 2);
+    expect(mix.last.byteSize, 2 * 9216);
+  });
+
+  test('detects truncated files', () {
+    expect(buildInfo().isComplete, isTrue);
+    expect(buildInfo(fileSize: 20000).isComplete, isFalse);
+  });
+
+  test('splits memory estimates between host and GPU', () {
+    final info = buildInfo();
+    final cpu = info.estimateMemory(contextSize: 128);
+    final partial = info.estimateMemory(contextSize: 128, gpuLayers: 1);
+    final full = info.estimateMemory(contextSize: 128, gpuLayers: 99);
+
+    // 2 kv heads * (8 + 8) dims * 2 bytes per token and layer.
+    expect(cpu.kvCacheBytes, 128 * 2 * 16 * 2 * 2);
+    expect(cpu.vramBytes, 0);
+    expect(cpu.weightsBytes, info.tensorBytes);
+    expect(partial.vramBytes, greaterThan(0));
+    expect(partial.ramBytes, greaterThan(full.ramBytes));
+    // Token embeddings stay on the host even when fully offloaded.
+    expect(full.ramBytes, 12800);
+    expect(full.totalBytes, cpu.totalBytes);
+  });
+}
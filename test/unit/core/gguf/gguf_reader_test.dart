@@ -0,0 +1,181 @@
+import 'dart:convert';
+import 'dart:typed_data';
+
+import 'package:llamadart/src/core/gguf/gguf_reader.dart';
+import 'package:test/test.dart';
+
+void main() {
+  group('GgufReader', () {
+    test('parses header, metadata and tensor table', () {
+      final bytes = _buildGguf(
+        metadata: [
+          _kv('general.architecture', 8, _str('llama')),
+          _kv('general.file_type', 4, _u32(15)),
+          _kv('llama.block_count', 4, _u32(2)),
+          _kv('llama.rope.freq_base', 6, _f32(10000)),
+          _kv('general.quantized', 7, [1]),
+          _kv('llama.small', 9, [
+            ..._u32(4),
+            ..._u64(3),
+            ..._u32(1),
+            ..._u32(2),
+            ..._u32(3),
+          ]),
+        ],
+        tensors: [
+          _tensor('token_embd.weight', [4, 2], 0, 0),
+          _tensor('blk.0.attn_q.weight', [64, 2], 2, 32),
+        ],
+        dataBytes: 32 + 72,
+      );
+
+      final info = GgufReader.parseBytes(bytes);
+
+      expect(info.version, 3);
+      expect(info.architecture, 'llama');
+      expect(info.metadata['general.file_type'], 15);
+      expect(info.metadata['llama.rope.freq_base'], 10000.0);
+      expect(info.metadata['general.quantized'], isTrue);
+      expect(info.metadata['llama.small'], [1, 2, 3]);
+      expect(info.tensors, hasLength(2));
+      expect(info.tensors[0].typeName, 'F32');
+      expect(info.tensors[0].byteSize, 32);
+      expect(info.tensors[1].typeName, 'Q4_0');
+      expect(info.tensors[1].byteSize, 2 * 2 * 18);
+      expect(info.tensors[1].blockIndex, 0);
+      expect(info.dataOffset % 32, 0);
+      expect(info.isComplete, isTrue);
+    });
+
+    test('skips large arrays but keeps their length', () {
+      final count = GgufReader.maxMaterializedArrayLength + 1;
+      final array = <int>[..._u32(8), ..._u64(count)];
+      for (var i = 0; i < count; i++) {
+        array.addAll(_str('t$i'));
+      }
+      final bytes = _buildGguf(
+        metadata: [
+          _kv('tokenizer.ggml.tokens', 9, array),
+          _kv('general.name', 8, _str('after')),
+        ],
+      );
+
+      final info = GgufReader.parseBytes(bytes);
+      final tokens = info.metadata['tokenizer.ggml.tokens'];
+
+      expect(tokens, isA<GgufArrayInfo>());
+      expect((tokens as GgufArrayInfo).length, count);
+      expect(tokens.elementType, GgufValueType.string);
+      expect(info.name, 'after');
+    });
+
+    test('keeps uint64 metadata above the int64 range as BigInt', () {
+      final bytes = _buildGguf(
+        metadata: [
+          _kv('general.seed', 10, [..._u32(0xFFFFFFFF), ..._u32(0xFFFFFFFF)]),
+          _kv('general.size', 10, _u64(7)),
+        ],
+      );
+
+      final info = GgufReader.parseBytes(bytes);
+
+      expect(
+        info.metadata['general.seed'],
+        BigInt.parse('18446744073709551615'),
+      );
+      expect(info.metadata['general.size'], 7);
+      expect(
+        info.toMetadataStrings()['general.seed'],
+        '18446744073709551615',
+      );
+    });
+
+    test('honors general.alignment for the data section', () {
+      final bytes = _buildGguf(
+        metadata: [_kv('general.alignment', 4, _u32(64))],
+        tensors: [_tensor('output.weight', [8], 0, 0)],
+        dataBytes: 32,
+        alignment: 64,
+      );
+
+      final info = GgufReader.parseBytes(bytes);
+
+      expect(info.dataOffset % 64, 0);
+      expect(info.isComplete, isTrue);
+    });
+
+    test('reports truncated tensor data as incomplete', () {
+      final bytes = _buildGguf(
+        tensors: [_tensor('output.weight', [16], 0, 0)],
+        dataBytes: 8,
+      );
+
+      expect(GgufReader.parseBytes(bytes).isComplete, isFalse);
+    });
+
+    test('rejects files without GGUF magic', () {
+      final bytes = _buildGguf();
+      bytes[0] = 0x00;
+
+      expect(() => GgufReader.parseBytes(bytes), throwsFormatException);
+    });
+
+    test('rejects headers cut off mid-metadata', () {
+      final bytes = _buildGguf(
+        metadata: [_kv('general.name', 8, _str('a long model name'))],
+      );
+
+      expect(
+        () => GgufReader.parseBytes(Uint8List.sublistView(bytes, 0, 30)),
+        throwsFormatException,
+      );
+    });
+  });
+}
+
+List<int> _u32(int value) =>
+    (ByteData(4)..setUint32(0, value, Endian.little)).buffer.asUint8List();
+
+List<int> _u64(int value) => [..._u32(value), ..._u32(0)];
+
+List<int> _f32(double value) =>
+    (ByteData(4)..setFloat32(0, value, Endian.little)).buffer.asUint8List();
+
+List<int> _str(String value) {
+  final encoded = utf8.encode(value);
+  return [..._u64(encoded.length), ...encoded];
+}
+
+List<int> _kv(String key, int type, List<int> value) => [
+  ..._str(key),
+  ..._u32(type),
+  ...value,
+];
+
+List<int> _tensor(String name, List<int> shape, int type, int offset) => [
+  ..._str(name),
+  ..._u32(shape.length),
+  for (final dim in shape) ..._u64(dim),
+  ..._u32(type),
+  ..._u64(offset),
+];
+
+Uint8List _buildGguf({
+  List<List<int>> metadata = const [],
+  List<List<int>> tensors = const [],
+  int dataBytes = 0,
+  int alignment = 32,
+}) {
+  final builder = BytesBuilder()
+    ..add(ascii.encode('GGUF'))
+    ..add(_u32(3))
+    ..add(_u64(tensors.length))
+    ..add(_u64(metadata.length));
+  metadata.forEach(builder.add);
+  tensors.forEach(builder.add);
+  final padding = (alignment - builder.length % alignment) % alignment;
+  builder
+    ..add(List<int>.filled(padding, 0))
+    ..add(List<int>.filled(dataBytes, 0));
+  return builder.toBytes();
+}
@@ -7,4 +7,26 @@ void main() {
     expect(config.path, 'adapter.gguf');
     expect(config.scale, 0.75);
   });
+
+  test('LoraAdapterConfig.setKey is order independent', () {
+    const a = LoraAdapterConfig(path: 'a.gguf', scale: 0.5);
+    const b = LoraAdapterConfig(path: 'b.gguf');
+
+    expect(LoraAdapterConfig.setKey([a, b]), LoraAdapterConfig.setKey([b, a]));
+    expect(LoraAdapterConfig.setKey(const []), isEmpty);
+  });
+
+  test('LoraAdapterConfig.setKey distinguishes scales and keeps last', () {
+    const low = LoraAdapterConfig(path: 'a.gguf', scale: 0.5);
+    const high = LoraAdapterConfig(path: 'a.gguf', scale: 1.0);
+
+    expect(
+      LoraAdapterConfig.setKey([low]),
+      isNot(LoraAdapterConfig.setKey([high])),
+    );
+    expect(
+      LoraAdapterConfig.setKey([low, high]),
+      LoraAdapterConfig.setKey([high]),
+    );
+  });
 }
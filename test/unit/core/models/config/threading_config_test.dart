@@ -0,0 +1,28 @@
+import 'package:llamadart/src/core/models/config/threading_config.dart';
+import 'package:test/test.dart';
+
+void main() {
+  test('ThreadingConfig defaults keep library behavior', () {
+    const config = ThreadingConfig();
+
+    expect(config.autotune, isFalse);
+    expect(config.persistentThreadpool, isFalse);
+    expect(config.cpuAffinity, isEmpty);
+    expect(config.pollLevel, ThreadingConfig.defaultPollLevel);
+    expect(config.numa, NumaStrategy.disabled);
+  });
+
+  test('ThreadingConfig copyWith updates selected fields', () {
+    const config = ThreadingConfig(autotune: true);
+    final updated = config.copyWith(
+      persistentThreadpool: true,
+      cpuAffinity: [0, 1],
+      numa: NumaStrategy.distribute,
+    );
+
+    expect(updated.autotune, isTrue);
+    expect(updated.persistentThreadpool, isTrue);
+    expect(updated.cpuAffinity, [0, 1]);
+    expect(updated.numa, NumaStrategy.distribute);
+  });
+}
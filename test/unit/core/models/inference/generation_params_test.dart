@@ -1,3 +1,4 @@
+import 'package:llamadart/src/core/models/config/lora_config.dart';
 import 'package:llamadart/src/core/models/inference/generation_params.dart';
 import 'package:test/test.dart';
 
@@ -44,4 +45,30 @@ void main() {
     expect(params.streamBatchTokenThreshold, 8);
     expect(params.streamBatchByteThreshold, 512);
   });
+
+  test('GenerationParams leaves prompt-lookup decoding off by default', () {
+    const params = GenerationParams();
+    expect(params.promptLookupDraftTokens, 0);
+    expect(params.promptLookupNgramSize, 3);
+
+    final updated = params.copyWith(
+      promptLookupDraftTokens: 8,
+      promptLookupNgramSize: 4,
+    );
+    expect(updated.promptLookupDraftTokens, 8);
+    expect(updated.promptLookupNgramSize, 4);
+    expect(updated.copyWith(temp: 0.1).promptLookupDraftTokens, 8);
+  });
+
+  test('GenerationParams carries per-request LoRA adapters', () {
+    const params = GenerationParams();
+    expect(params.loras, isNull);
+
+    final updated = params.copyWith(
+      loras: const [LoraAdapterConfig(path: 'tenant.gguf', scale: 0.5)],
+    );
+    expect(updated.loras, hasLength(1));
+    expect(updated.loras!.single.scale, 0.5);
+    expect(updated.copyWith(temp: 0.1).loras, same(updated.loras));
+  });
 }
@@ -0,0 +1,22 @@
+import 'package:llamadart/src/core/models/inference/lora_switch_stats.dart';
+import 'package:test/test.dart';
+
+void main() {
+  test('LoraSwitchStats defaults to no switches', () {
+    const stats = LoraSwitchStats();
+
+    expect(stats.activeAdapterSet, isEmpty);
+    expect(stats.swapCount, 0);
+    expect(stats.averageSwapTime, Duration.zero);
+    expect(stats.totalSnapshotTime, Duration.zero);
+  });
+
+  test('LoraSwitchStats averages swap time', () {
+    const stats = LoraSwitchStats(
+      swapCount: 4,
+      totalSwapTime: Duration(milliseconds: 10),
+    );
+
+    expect(stats.averageSwapTime, const Duration(microseconds: 2500));
+  });
+}
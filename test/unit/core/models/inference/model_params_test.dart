@@ -1,4 +1,5 @@
 import 'package:llamadart/src/core/models/config/gpu_backend.dart';
+import 'package:llamadart/src/core/models/config/threading_config.dart';
 import 'package:llamadart/src/core/models/inference/model_params.dart';
 import 'package:test/test.dart';
 
@@ -14,4 +15,24 @@ void main() {
     expect(updated.gpuLayers, 2);
     expect(updated.preferredBackend, GpuBackend.metal);
   });
+
+  test('ModelParams carries threading configuration', () {
+    const params = ModelParams();
+    expect(params.threading.autotune, isFalse);
+
+    final updated = params.copyWith(
+      threading: const ThreadingConfig(autotune: true),
+    );
+    expect(updated.threading.autotune, isTrue);
+    expect(updated.copyWith(contextSize: 512).threading.autotune, isTrue);
+  });
+
+  test('ModelParams keeps LoRA prefix snapshots off by default', () {
+    const params = ModelParams();
+    expect(params.loraSnapshotBytes, 0);
+
+    final updated = params.copyWith(loraSnapshotBytes: 64 << 20);
+    expect(updated.loraSnapshotBytes, 64 << 20);
+    expect(updated.copyWith(contextSize: 512).loraSnapshotBytes, 64 << 20);
+  });
 }
@@ -0,0 +1,25 @@
+import 'package:llamadart/src/core/models/inference/prompt_lookup_stats.dart';
+import 'package:test/test.dart';
+
+void main() {
+  test('PromptLookupStats defaults to no drafts', () {
+    const stats = PromptLookupStats();
+
+    expect(stats.draftedTokens, 0);
+    expect(stats.acceptanceRate, 0.0);
+    expect(stats.tokensPerDecode, 0.0);
+  });
+
+  test('PromptLookupStats derives acceptance and decode savings', () {
+    const stats = PromptLookupStats(
+      generatedTokens: 30,
+      decodeCalls: 12,
+      draftBatches: 8,
+      draftedTokens: 24,
+      acceptedTokens: 18,
+    );
+
+    expect(stats.acceptanceRate, 0.75);
+    expect(stats.tokensPerDecode, 2.5);
+  });
+}
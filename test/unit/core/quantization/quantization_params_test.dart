@@ -0,0 +1,43 @@
+import 'package:llamadart/src/core/quantization/quantization_params.dart';
+import 'package:llamadart/src/core/quantization/quantization_type.dart';
+import 'package:test/test.dart';
+
+void main() {
+  test('QuantizationParams defaults follow llama.cpp', () {
+    const params = QuantizationParams(type: QuantizationType.q4KM);
+
+    expect(params.type, QuantizationType.q4KM);
+    expect(params.threads, 0);
+    expect(params.outputTensorType, isNull);
+    expect(params.tokenEmbeddingType, isNull);
+    expect(params.allowRequantize, isFalse);
+    expect(params.quantizeOutputTensor, isTrue);
+    expect(params.pure, isFalse);
+  });
+
+  test('QuantizationParams keeps explicit options', () {
+    const params = QuantizationParams(
+      type: QuantizationType.q80,
+      threads: 4,
+      outputTensorType: 'Q8_0',
+      tokenEmbeddingType: 'Q6_K',
+      allowRequantize: true,
+      quantizeOutputTensor: false,
+      pure: true,
+    );
+
+    expect(params.threads, 4);
+    expect(params.outputTensorType, 'Q8_0');
+    expect(params.tokenEmbeddingType, 'Q6_K');
+    expect(params.allowRequantize, isTrue);
+    expect(params.quantizeOutputTensor, isFalse);
+    expect(params.pure, isTrue);
+  });
+
+  test('QuantizationParams rejects negative thread counts', () {
+    expect(
+      () => QuantizationParams(type: QuantizationType.q4KM, threads: -1),
+      throwsA(isA<AssertionError>()),
+    );
+  });
+}
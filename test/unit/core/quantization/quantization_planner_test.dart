@@ -0,0 +1,238 @@
+import 'package:llamadart/src/core/gguf/gguf_model_info.dart';
+import 'package:llamadart/src/core/gguf/gguf_reader.dart';
+import 'package:llamadart/src/core/quantization/quantization_params.dart';
+import 'package:llamadart/src/core/quantization/quantization_planner.dart';
+import 'package:llamadart/src/core/quantization/quantization_type.dart';
+import 'package:test/test.dart';
+
+void main() {
+  const f16 = 1;
+  const q4K = 12;
+  const q6K = 14;
+
+  GgufModelInfo buildF16Model({bool withOutput = true}) {
+    final tensors = <GgufTensorInfo>[];
+    var offset = 0;
+    void add(String name, List<int> shape, {int type = f16}) {
+      final elements = shape.fold(1, (a, b) => a * b);
+      final bytes = elements * (type == 0 ? 4 : 2);
+      tensors.add(
+        GgufTensorInfo(
+          name: name,
+          shape: shape,
+          type: type,
+          offset: offset,
+          byteSize: bytes,
+        ),
+      );
+      offset += bytes;
+    }
+
+    add('token_embd.weight', [256, 1000]);
+    for (var i = 0; i < 8; i++) {
+      add('blk.$i.attn_norm.weight', [256], type: 0);
+      add('blk.$i.attn_v.weight', [256, 256]);
+      add('blk.$i.ffn_down.weight', [256, 256]);
+      add('blk.$i.ffn_up.weight', [256, 256]);
+    }
+    if (withOutput) add('output.weight', [256, 1000]);
+
+    return GgufModelInfo(
+      version: 3,
+      metadata: {
+        'general.architecture': 'llama',
+        'general.file_type': 1,
+        'llama.block_count': 8,
+        'llama.embedding_length': 256,
+        'llama.feed_forward_length': 256,
+        'llama.attention.head_count': 4,
+        'tokenizer.ggml.tokens': const GgufArrayInfo(
+          GgufValueType.string,
+          1000,
+        ),
+      },
+      tensors: tensors,
+      dataOffset: 4096,
+      fileSize: 4096 + offset,
+    );
+  }
+
+  Map<String, int> typesByName(GgufModelInfo info) => {
+    for (final tensor in info.tensors) tensor.name: tensor.type,
+  };
+
+  group('predictQuantizedModel', () {
+    test('applies the Q4_K_M layer mix', () {
+      final predicted = predictQuantizedModel(
+        buildF16Model(),
+        const QuantizationParams(type: QuantizationType.q4KM),
+      );
+      final types = typesByName(predicted);
+
+      expect(types['blk.0.attn_norm.weight'], 0);
+      expect(types['token_embd.weight'], q4K);
+      expect(types['output.weight'], q6K);
+      // use_more_bits picks layers 0, 3, 6 and 7 of 8.
+      for (var i = 0; i < 8; i++) {
+        final upgraded = {0, 3, 6, 7}.contains(i);
+        expect(types['blk.$i.attn_v.weight'], upgraded ? q6K : q4K);
+        expect(types['blk.$i.ffn_down.weight'], upgraded ? q6K : q4K);
+        expect(types['blk.$i.ffn_up.weight'], q4K);
+      }
+      expect(predicted.metadata['general.file_type'], 15);
+      expect(predicted.fileTypeName, 'Q4_K_M');
+      final up = predicted.tensors.firstWhere(
+        (t) => t.name == 'blk.1.ffn_up.weight',
+      );
+      expect(up.byteSize, 256 * 144);
+      expect(predicted.fileSize, lessThan(buildF16Model().fileSize));
+    });
+
+    test('honors pure mode and tensor type overrides', () {
+      final predicted = predictQuantizedModel(
+        buildF16Model(),
+        const QuantizationParams(
+          type: QuantizationType.q4KM,
+          pure: true,
+          outputTensorType: 'q8_0',
+          tokenEmbeddingType: 'F16',
+        ),
+      );
+      final types = typesByName(predicted);
+
+      expect(types['blk.0.attn_v.weight'], q4K);
+      expect(types['output.weight'], 8);
+      expect(types['token_embd.weight'], f16);
+      expect(
+        () => predictQuantizedModel(
+          buildF16Model(),
+          const QuantizationParams(
+            type: QuantizationType.q4KM,
+            outputTensorType: 'Q9_9',
+          ),
+        ),
+        throwsArgumentError,
+      );
+    });
+
+    test('treats tied embeddings as the output tensor', () {
+      final predicted = predictQuantizedModel(
+        buildF16Model(withOutput: false),
+        const QuantizationParams(type: QuantizationType.q5KS),
+      );
+
+      expect(typesByName(predicted)['token_embd.weight'], q6K);
+    });
+
+    test('falls back when rows do not fill whole blocks', () {
+      final source = GgufModelInfo(
+        version: 3,
+        metadata: const {},
+        tensors: const [
+          GgufTensorInfo(
+            name: 'a.weight',
+            shape: [96, 4],
+            type: f16,
+            offset: 0,
+            byteSize: 768,
+          ),
+          GgufTensorInfo(
+            name: 'b.weight',
+            shape: [100, 4],
+            type: f16,
+            offset: 768,
+            byteSize: 800,
+          ),
+        ],
+        dataOffset: 0,
+        fileSize: 1568,
+      );
+      final types = typesByName(
+        predictQuantizedModel(
+          source,
+          const QuantizationParams(type: QuantizationType.q4KS),
+        ),
+      );
+
+      expect(types['a.weight'], 6); // Q5_0
+      expect(types['b.weight'], f16);
+    });
+  });
+
+  group('pickQuantizationToFit', () {
+    test('keeps a model that already fits', () {
+      final source = buildF16Model();
+      final fit = pickQuantizationToFit(
+        source,
+        const QuantizationBudget(contextSize: 512, ramBytes: 1 << 40),
+      );
+
+      expect(fit, isNotNull);
+      expect(fit!.params, isNull);
+      expect(fit.model, same(source));
+    });
+
+    test('picks the best type within the budget', () {
+      final source = buildF16Model();
+      final q8 = predictQuantizedModel(
+        source,
+        const QuantizationParams(type: QuantizationType.q80),
+      ).estimateMemory(contextSize: 512);
+
+      final fit = pickQuantizationToFit(
+        source,
+        QuantizationBudget(contextSize: 512, ramBytes: q8.ramBytes - 1),
+      );
+
+      expect(fit!.params!.type, QuantizationType.q6K);
+      expect(fit.params!.allowRequantize, isFalse);
+      expect(fit.estimate.ramBytes, lessThan(q8.ramBytes));
+    });
+
+    test('sizes compute buffers for a context-wide batch', () {
+      const contextSize = 32768;
+      final source = buildF16Model();
+      // A 512-row compute buffer would make the source look like it fits.
+      final smallBatch = source.estimateMemory(contextSize: contextSize);
+
+      final fit = pickQuantizationToFit(
+        source,
+        QuantizationBudget(
+          contextSize: contextSize,
+          ramBytes: smallBatch.ramBytes,
+        ),
+      );
+      expect(fit, isNull);
+
+      final roomy = pickQuantizationToFit(
+        source,
+        const QuantizationBudget(contextSize: contextSize, ramBytes: 1 << 40),
+      );
+      expect(
+        roomy!.estimate.computeBytes,
+        contextSize * (1000 + 4 * 256 + 2 * 256) * 4,
+      );
+    });
+
+    test('returns null when nothing fits', () {
+      final fit = pickQuantizationToFit(
+        buildF16Model(),
+        const QuantizationBudget(contextSize: 512, ramBytes: 1),
+      );
+
+      expect(fit, isNull);
+    });
+  });
+
+  test('ggmlTypeIdForName is case-insensitive', () {
+    expect(ggmlTypeIdForName('q4_k'), q4K);
+    expect(ggmlTypeIdForName('BF16'), 30);
+    expect(ggmlTypeIdForName('nope'), isNull);
+  });
+
+  test('QuantizationType.fromLabel matches llama.cpp names', () {
+    expect(QuantizationType.fromLabel('q4_k_m'), QuantizationType.q4KM);
+    expect(QuantizationType.fromLabel('Q8_0')!.fileType, 7);
+    expect(QuantizationType.fromLabel('IQ2_XXS'), isNull);
+  });
+}
@@ -0,0 +1,50 @@
+import 'package:llamadart/src/core/quantization/quantization_type.dart';
+import 'package:test/test.dart';
+
+void main() {
+  test('QuantizationType maps to llama_ftype ids', () {
+    final fileTypes = {
+      for (final type in QuantizationType.values) type.label: type.fileType,
+    };
+
+    expect(fileTypes, {
+      'Q2_K': 10,
+      'Q3_K_S': 11,
+      'Q3_K_M': 12,
+      'Q3_K_L': 13,
+      'Q4_0': 2,
+      'Q4_1': 3,
+      'Q4_K_S': 14,
+      'Q4_K_M': 15,
+      'Q5_0': 8,
+      'Q5_1': 9,
+      'Q5_K_S': 16,
+      'Q5_K_M': 17,
+      'Q6_K': 18,
+      'Q8_0': 7,
+    });
+  });
+
+  test('QuantizationType records the ggml tensor types of each mix', () {
+    expect(QuantizationType.q80.baseTensorType, 8);
+    expect(QuantizationType.q4KM.baseTensorType, 12);
+    expect(QuantizationType.q4KM.attentionValueType, 14);
+    expect(QuantizationType.q4KM.feedForwardDownType, 14);
+    expect(QuantizationType.q4KM.upgradesSomeLayers, isTrue);
+    expect(QuantizationType.q3KM.upgradesSomeLayers, isFalse);
+    expect(QuantizationType.q4KS.attentionValueType, isNull);
+  });
+
+  test('fromLabel is case-insensitive and rejects unknown labels', () {
+    expect(QuantizationType.fromLabel('q4_k_m'), QuantizationType.q4KM);
+    expect(QuantizationType.fromLabel('Q8_0'), QuantizationType.q80);
+    expect(QuantizationType.fromLabel('IQ2_XS'), isNull);
+  });
+
+  test('byQuality lists K-quant candidates from largest to smallest', () {
+    expect(QuantizationType.byQuality.first, QuantizationType.q80);
+    expect(QuantizationType.byQuality.last, QuantizationType.q2K);
+    expect(QuantizationType.byQuality.toSet(), hasLength(10));
+    expect(QuantizationType.byQuality, isNot(contains(QuantizationType.q40)));
+  });
+}
@@ -0,0 +1,54 @@
+import 'dart:typed_data';
+
+import 'package:llamadart/src/core/vocab/token_batch.dart';
+import 'package:test/test.dart';
+
+void main() {
+  test('packs token lists and exposes per-text views', () {
+    final batch = TokenBatch.fromLists([
+      [1, 2, 3],
+      [],
+      [4],
+    ]);
+
+    expect(batch.length, 3);
+    expect(batch.tokens, [1, 2, 3, 4]);
+    expect(batch.offsets, [0, 3, 3, 4]);
+    expect(batch[0], [1, 2, 3]);
+    expect(batch[1], isEmpty);
+    expect(batch.tokenCount(2), 1);
+    expect(batch.tokenCounts, [3, 0, 1]);
+  });
+
+  test('concat rebases offsets of later batches', () {
+    final batch = TokenBatch.concat([
+      TokenBatch.fromLists([
+        [1],
+        [2, 3],
+      ]),
+      TokenBatch.fromLists([
+        [4, 5, 6],
+      ]),
+      TokenBatch.fromLists([]),
+    ]);
+
+    expect(batch.length, 3);
+    expect(batch.offsets, [0, 1, 3, 6]);
+    expect(batch[2], [4, 5, 6]);
+  });
+
+  test('rejects offsets that do not span the tokens', () {
+    expect(
+      () => TokenBatch(
+        tokens: Int32List(2),
+        offsets: Uint32List.fromList([0, 1]),
+      ),
+      throwsArgumentError,
+    );
+    expect(
+      () => TokenBatch(tokens: Int32List(0), offsets: Uint32List(0)),
+      throwsArgumentError,
+    );
+    expect(() => TokenBatch.fromLists([]).tokenCount(0), throwsRangeError);
+  });
+}
@@ -0,0 +1,41 @@
+import 'dart:convert';
+
+import 'package:llamadart/src/core/vocab/utf8_assembler.dart';
+import 'package:test/test.dart';
+
+void main() {
+  test('holds back a split code point until it completes', () {
+    final assembler = Utf8Assembler();
+    final bytes = utf8.encode('a😀b');
+
+    expect(assembler.add(bytes.sublist(0, 2)), 'a');
+    expect(assembler.pendingBytes, 1);
+    expect(assembler.add(bytes.sublist(2, 4)), '');
+    expect(assembler.pendingBytes, 3);
+    expect(assembler.add(bytes.sublist(4)), '😀b');
+    expect(assembler.pendingBytes, 0);
+  });
+
+  test('passes complete pieces through unchanged', () {
+    final assembler = Utf8Assembler();
+
+    expect(assembler.add(utf8.encode('héllo')), 'héllo');
+    expect(assembler.add(const []), '');
+    expect(assembler.flush(), '');
+  });
+
+  test('flush replaces an unfinished sequence', () {
+    final assembler = Utf8Assembler();
+
+    expect(assembler.add([0xe2, 0x82]), '');
+    expect(assembler.flush(), '�');
+    expect(assembler.pendingBytes, 0);
+  });
+
+  test('does not hold back stray continuation bytes', () {
+    final assembler = Utf8Assembler();
+
+    expect(assembler.add([0x80, 0x80, 0x80, 0x80]), '�' * 4);
+    expect(assembler.pendingBytes, 0);
+  });
+}
@@ -0,0 +1,71 @@
+import 'dart:convert';
+import 'dart:typed_data';
+
+import 'package:llamadart/src/core/vocab/vocab_piece_table.dart';
+import 'package:test/test.dart';
+
+VocabPieceTable _table(List<String> pieces, {Set<int> hidden = const {}}) {
+  final builder = BytesBuilder(copy: false);
+  final offsets = Uint32List(pieces.length + 1);
+  for (var i = 0; i < pieces.length; i++) {
+    offsets[i] = builder.length;
+    builder.add(utf8.encode(pieces[i]));
+  }
+  offsets[pieces.length] = builder.length;
+  return VocabPieceTable(
+    bytes: builder.takeBytes(),
+    offsets: offsets,
+    flags: Uint8List.fromList([
+      for (var i = 0; i < pieces.length; i++)
+        hidden.contains(i) ? VocabPieceTable.hiddenUnlessSpecial : 0,
+    ]),
+  );
+}
+
+void main() {
+  test('detokenizes pieces and hides control tokens by default', () {
+    final table = _table(['<s>', 'Hello', ',', ' world'], hidden: {0});
+
+    expect(table.vocabSize, 4);
+    expect(table.detokenize([0, 1, 2, 3]), 'Hello, world');
+    expect(table.detokenize([0, 1], special: true), '<s>Hello');
+    expect(table.isHidden(0), isTrue);
+    expect(table.pieceBytes(0), isEmpty);
+    expect(utf8.decode(table.pieceBytes(3)), ' world');
+  });
+
+  test('keeps pieces longer than a fixed scratch buffer', () {
+    final long = 'x' * 1000;
+    final table = _table(['a', long]);
+
+    expect(table.pieceBytes(1), hasLength(1000));
+    expect(table.detokenize([0, 1, 0]), 'a${long}a');
+  });
+
+  test('joins byte tokens that split a code point', () {
+    final euro = utf8.encode('€');
+    final table = VocabPieceTable(
+      bytes: Uint8List.fromList(euro),
+      offsets: Uint32List.fromList([0, 1, 2, 3]),
+      flags: Uint8List(3),
+    );
+
+    expect(table.detokenize([0, 1, 2]), '€');
+    expect(table.detokenize([0, 1]), '�');
+  });
+
+  test('rejects out-of-range tokens and inconsistent arrays', () {
+    final table = _table(['a']);
+
+    expect(() => table.pieceBytes(1), throwsRangeError);
+    expect(() => table.detokenize([-1]), throwsRangeError);
+    expect(
+      () => VocabPieceTable(
+        bytes: Uint8List(2),
+        offsets: Uint32List.fromList([0, 1]),
+        flags: Uint8List(1),
+      ),
+      throwsArgumentError,
+    );
+  });
+}
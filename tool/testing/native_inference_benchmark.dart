@@ -22,6 +22,7 @@ Future<void> main(List<String> arguments) async {
     reusePromptPrefix: options.reusePromptPrefix,
     streamBatchTokenThreshold: options.streamBatchTokenThreshold,
     streamBatchByteThreshold: options.streamBatchByteThreshold,
+    promptLookupDraftTokens: options.promptLookupDraftTokens,
   );
 
   try {
@@ -48,6 +49,7 @@ Future<void> main(List<String> arguments) async {
       'reuse_prompt_prefix': options.reusePromptPrefix,
       'stream_batch_token_threshold': options.streamBatchTokenThreshold,
       'stream_batch_byte_threshold': options.streamBatchByteThreshold,
+      'prompt_lookup_draft_tokens': options.promptLookupDraftTokens,
       'prompt_preview': options.prompt.length > 80
           ? '${options.prompt.substring(0, 80)}...'
           : options.prompt,
@@ -80,6 +82,18 @@ Future<void> main(List<String> arguments) async {
       report['metrics']['create'] = _summarize(samples);
     }
 
+    final lookupStats = options.promptLookupDraftTokens > 0
+        ? await engine.getPromptLookupStats()
+        : null;
+    if (lookupStats != null) {
+      report['prompt_lookup'] = <String, dynamic>{
+        'drafted_tokens': lookupStats.draftedTokens,
+        'accepted_tokens': lookupStats.acceptedTokens,
+        'acceptance_rate': lookupStats.acceptanceRate,
+        'tokens_per_decode': lookupStats.tokensPerDecode,
+      };
+    }
+
     stdout.writeln(const JsonEncoder.withIndent('  ').convert(report));
   } finally {
     await engine.dispose();
@@ -263,6 +277,10 @@ void _printUsage() {
     '  --reuse-prompt-prefix <bool>  Reuse native prompt prefix '
     '(default: ${GenerationParams.defaultReusePromptPrefix})',
   );
+  stdout.writeln(
+    '  --prompt-lookup-draft <n>  Prompt-lookup draft tokens, 0 = off '
+    '(default: 0)',
+  );
   stdout.writeln('  --help                   Show this help');
 }
 
@@ -299,6 +317,7 @@ class _BenchmarkOptions {
   final bool reusePromptPrefix;
   final int streamBatchTokenThreshold;
   final int streamBatchByteThreshold;
+  final int promptLookupDraftTokens;
 
   const _BenchmarkOptions({
     required this.showHelp,
@@ -321,6 +340,7 @@ class _BenchmarkOptions {
     required this.reusePromptPrefix,
     required this.streamBatchTokenThreshold,
     required this.streamBatchByteThreshold,
+    required this.promptLookupDraftTokens,
   });
 
   static _BenchmarkOptions parse(List<String> args) {
@@ -392,6 +412,10 @@ class _BenchmarkOptions {
         map['stream-batch-bytes'],
         fallback: GenerationParams.defaultStreamBatchByteThreshold,
       ),
+      promptLookupDraftTokens: _parseInt(
+        map['prompt-lookup-draft'],
+        fallback: 0,
+      ),
     );
   }
 